@@ -0,0 +1,124 @@
+#include "AsyncReadback.h"
+
+static int bytesPerPixel(GLenum format, GLenum type)
+{
+    int components = 4;
+    if (format == GL_RED || format == GL_RED_INTEGER)
+        components = 1;
+    else if (format == GL_RG || format == GL_RG_INTEGER)
+        components = 2;
+    else if (format == GL_RGB)
+        components = 3;
+
+    int componentSize = (type == GL_UNSIGNED_BYTE) ? 1 : 4;
+    return components * componentSize;
+}
+
+AsyncReadback::AsyncReadback()
+    :
+    head(0),
+    pending(0)
+{
+}
+
+AsyncReadback::AsyncReadback(int ringSize)
+    :
+    slots(ringSize),
+    head(0),
+    pending(0)
+{
+    for (Slot& slot : slots)
+    {
+        glGenBuffers(1, &slot.buffer);
+    }
+}
+
+bool AsyncReadback::request(const Framebuffer& source, int attachment, GLenum format, GLenum type, int tag)
+{
+    if (pending == (int)slots.size())
+        return false;
+
+    Slot& slot = slots[(head + pending) % slots.size()];
+    slot.tag = tag;
+    slot.width = source.getWidth();
+    slot.height = source.getHeight();
+
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, slot.buffer);
+    GLsizeiptr size = (GLsizeiptr)slot.width * slot.height * bytesPerPixel(format, type);
+    if (size > slot.capacity)
+    {
+        glBufferData(GL_PIXEL_PACK_BUFFER, size, NULL, GL_STREAM_READ);
+        slot.capacity = size;
+    }
+
+    //With a pack buffer bound the last argument is an offset into it, the call returns immediately
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, source.getID());
+    glReadBuffer(GL_COLOR_ATTACHMENT0 + attachment);
+    glPixelStorei(GL_PACK_ALIGNMENT, 1);
+    glReadPixels(0, 0, slot.width, slot.height, format, type, (void*)0);
+    slot.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, 0);
+
+    ++pending;
+    return true;
+}
+
+void AsyncReadback::poll(const Callback& callback, bool block)
+{
+    while (pending > 0)
+    {
+        Slot& slot = slots[head];
+        //Only the oldest transfer may be waited for, the rest are checked without blocking
+        GLuint64 timeout = block ? 1000000000ull : 0;
+        GLenum status = glClientWaitSync(slot.fence, GL_SYNC_FLUSH_COMMANDS_BIT, timeout);
+        if (status == GL_TIMEOUT_EXPIRED)
+            return;
+        block = false;
+
+        glDeleteSync(slot.fence);
+        slot.fence = 0;
+
+        if (status == GL_WAIT_FAILED)
+        {
+            //Drop the transfer instead of waiting on a fence that will never signal
+            std::cout << "ERROR::READBACK::WAIT_FAILED for tag " << slot.tag << std::endl;
+        }
+        else
+        {
+            glBindBuffer(GL_PIXEL_PACK_BUFFER, slot.buffer);
+            const void* pixels = glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, slot.capacity, GL_MAP_READ_BIT);
+            if (pixels != nullptr)
+            {
+                callback(slot.tag, pixels, slot.width, slot.height);
+                glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+            }
+            glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+        }
+
+        head = (head + 1) % slots.size();
+        --pending;
+    }
+}
+
+void AsyncReadback::flush(const Callback& callback)
+{
+    while (pending > 0)
+    {
+        poll(callback, true);
+    }
+}
+
+void AsyncReadback::release()
+{
+    for (Slot& slot : slots)
+    {
+        if (slot.fence != 0)
+            glDeleteSync(slot.fence);
+        glDeleteBuffers(1, &slot.buffer);
+    }
+    slots.clear();
+    head = 0;
+    pending = 0;
+}
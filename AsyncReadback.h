@@ -0,0 +1,56 @@
+#pragma once
+#ifndef ASYNC_READBACK_H
+#define ASYNC_READBACK_H
+
+#include <GL/glew.h>
+
+#include <vector>
+#include <functional>
+#include <iostream>
+
+#include "Framebuffer.h"
+
+
+/*
+    Reads framebuffer attachments back to the host without stalling the pipeline.
+ 
+    Each request copies an attachment into a pixel buffer object and places a fence behind it.
+    The copy finishes on the GPU while the CPU records the next frames; poll() hands the pixels
+    of finished transfers to a callback in the order they were requested.
+    The ring size bounds how many frames can be in flight at once.
+*/
+class AsyncReadback
+{
+public:
+    //tag: user value given to request(), pixels: tightly packed rows starting from the bottom one
+    using Callback = std::function<void(int tag, const void* pixels, int width, int height)>;
+
+    AsyncReadback();
+    AsyncReadback(int ringSize);
+
+    //Queues a copy of the given color attachment. Returns false if every slot is in flight.
+    bool request(const Framebuffer& source, int attachment, GLenum format, GLenum type, int tag);
+    //Delivers finished transfers. If block is set, waits for at least the oldest one.
+    void poll(const Callback& callback, bool block = false);
+    //Waits for and delivers every pending transfer
+    void flush(const Callback& callback);
+    void release();
+
+private:
+    struct Slot
+    {
+        GLuint buffer = 0;
+        GLsizeiptr capacity = 0;
+        GLsync fence = 0;
+        int tag = 0;
+        int width = 0;
+        int height = 0;
+    };
+
+    std::vector<Slot> slots;
+    //Index of the oldest pending slot and the number of pending slots
+    int head;
+    int pending;
+};
+
+#endif
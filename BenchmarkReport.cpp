@@ -0,0 +1,129 @@
+#include "BenchmarkReport.h"
+
+#include <fstream>
+#include <iomanip>
+#include <algorithm>
+#include <numeric>
+#include <cmath>
+
+FrameTimeStats FrameTimeStats::compute(std::vector<double> samples)
+{
+    FrameTimeStats stats;
+    if (samples.empty())
+        return stats;
+
+    std::sort(samples.begin(), samples.end());
+    auto percentile = [&](double p)
+    {
+        size_t rank = (size_t)std::ceil(p * samples.size());
+        return samples[std::min(std::max(rank, (size_t)1), samples.size()) - 1];
+    };
+    stats.min = samples.front();
+    stats.max = samples.back();
+    stats.avg = std::accumulate(samples.begin(), samples.end(), 0.0) / samples.size();
+    stats.p95 = percentile(0.95);
+    stats.p99 = percentile(0.99);
+    return stats;
+}
+
+static std::string escapeJSON(const std::string& text)
+{
+    std::string escaped;
+    for (char c : text)
+    {
+        if (c == '"' || c == '\\')
+            escaped += '\\';
+        if ((unsigned char)c >= 0x20)
+            escaped += c;
+    }
+    return escaped;
+}
+
+static void writeStatsJSON(std::ostream& out, const FrameTimeStats& stats)
+{
+    out << "{\"min\": " << stats.min << ", \"avg\": " << stats.avg << ", \"p95\": " << stats.p95
+        << ", \"p99\": " << stats.p99 << ", \"max\": " << stats.max << "}";
+}
+
+static void writeSamplesJSON(std::ostream& out, const std::vector<double>& samples)
+{
+    out << "[";
+    for (size_t i = 0; i < samples.size(); ++i)
+    {
+        out << (i == 0 ? "" : ", ") << samples[i];
+    }
+    out << "]";
+}
+
+bool BenchmarkReport::writeCSV(const std::string& path) const
+{
+    std::ofstream file(path);
+    if (!file)
+    {
+        std::cout << "ERROR::BENCHMARK::FILE_NOT_SUCCESSFULLY_OPENED->" << path << std::endl;
+        return false;
+    }
+
+    file << std::fixed << std::setprecision(4);
+    file << "scene,width,height,frames,frame_min_ms,frame_avg_ms,frame_p95_ms,frame_p99_ms,frame_max_ms,"
+         << "gpu_min_ms,gpu_avg_ms,gpu_p95_ms,gpu_p99_ms,gpu_max_ms\n";
+    for (const SceneBenchmark& scene : scenes)
+    {
+        file << scene.scene << "," << scene.width << "," << scene.height << "," << scene.frameTimes.size() << ","
+             << scene.frame.min << "," << scene.frame.avg << "," << scene.frame.p95 << "," << scene.frame.p99 << "," << scene.frame.max << ","
+             << scene.gpu.min << "," << scene.gpu.avg << "," << scene.gpu.p95 << "," << scene.gpu.p99 << "," << scene.gpu.max << "\n";
+    }
+    return (bool)file;
+}
+
+bool BenchmarkReport::writeJSON(const std::string& path) const
+{
+    std::ofstream file(path);
+    if (!file)
+    {
+        std::cout << "ERROR::BENCHMARK::FILE_NOT_SUCCESSFULLY_OPENED->" << path << std::endl;
+        return false;
+    }
+
+    file << std::fixed << std::setprecision(4);
+    file << "{\n";
+    file << "  \"renderer\": \"" << escapeJSON(renderer) << "\",\n";
+    file << "  \"version\": \"" << escapeJSON(version) << "\",\n";
+    file << "  \"camera_path\": \"" << escapeJSON(cameraPath) << "\",\n";
+    file << "  \"time_step\": " << timeStep << ",\n";
+    file << "  \"warmup_frames\": " << warmupFrames << ",\n";
+    file << "  \"scenes\": [\n";
+    for (size_t i = 0; i < scenes.size(); ++i)
+    {
+        const SceneBenchmark& scene = scenes[i];
+        file << "    {\n";
+        file << "      \"scene\": \"" << escapeJSON(scene.scene) << "\",\n";
+        file << "      \"width\": " << scene.width << ",\n";
+        file << "      \"height\": " << scene.height << ",\n";
+        file << "      \"frame_ms\": ";
+        writeStatsJSON(file, scene.frame);
+        file << ",\n      \"gpu_ms\": ";
+        writeStatsJSON(file, scene.gpu);
+        file << ",\n      \"frame_times_ms\": ";
+        writeSamplesJSON(file, scene.frameTimes);
+        file << ",\n      \"gpu_times_ms\": ";
+        writeSamplesJSON(file, scene.gpuTimes);
+        file << "\n    }" << (i + 1 < scenes.size() ? "," : "") << "\n";
+    }
+    file << "  ]\n}\n";
+    return (bool)file;
+}
+
+void BenchmarkReport::print() const
+{
+    std::cout << "Benchmark on " << renderer << " (" << version << ")\n";
+    std::cout << std::fixed << std::setprecision(3);
+    for (const SceneBenchmark& scene : scenes)
+    {
+        std::cout << "  " << std::setw(10) << std::left << scene.scene << std::right
+                  << " frame ms min " << scene.frame.min << " avg " << scene.frame.avg
+                  << " p95 " << scene.frame.p95 << " p99 " << scene.frame.p99
+                  << " | gpu ms avg " << scene.gpu.avg << " p99 " << scene.gpu.p99 << "\n";
+    }
+    std::cout << std::defaultfloat << std::flush;
+}
@@ -0,0 +1,55 @@
+#pragma once
+#ifndef BENCHMARK_REPORT_H
+#define BENCHMARK_REPORT_H
+
+#include <string>
+#include <vector>
+#include <iostream>
+
+
+//Summary of a series of frame times in milliseconds
+struct FrameTimeStats
+{
+    double min = 0.0;
+    double avg = 0.0;
+    double p95 = 0.0;
+    double p99 = 0.0;
+    double max = 0.0;
+
+    //Percentiles use the nearest rank
+    static FrameTimeStats compute(std::vector<double> samples);
+};
+
+struct SceneBenchmark
+{
+    std::string scene;
+    int width = 0;
+    int height = 0;
+    //Wall time from submitting a frame until the GPU finished it
+    std::vector<double> frameTimes;
+    //GL_TIME_ELAPSED of the frame, empty if timer queries are unavailable
+    std::vector<double> gpuTimes;
+    FrameTimeStats frame;
+    FrameTimeStats gpu;
+};
+
+/*
+    Results of a benchmark run, one entry per scene.
+    The CSV holds one summary row per scene, the JSON also lists every frame time.
+*/
+struct BenchmarkReport
+{
+    //GL_RENDERER and GL_VERSION, driver changes are the usual suspect of a regression
+    std::string renderer;
+    std::string version;
+    std::string cameraPath;
+    double timeStep = 0.0;
+    int warmupFrames = 0;
+    std::vector<SceneBenchmark> scenes;
+
+    bool writeCSV(const std::string& path) const;
+    bool writeJSON(const std::string& path) const;
+    void print() const;
+};
+
+#endif
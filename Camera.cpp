@@ -60,6 +60,16 @@ glm::vec3 Camera::getUp() const
     return up;
 }
 
+float Camera::getYaw() const
+{
+    return yaw;
+}
+
+float Camera::getPitch() const
+{
+    return pitch;
+}
+
 void Camera::setSpeed(float speed_in)
 {
     movementSpeed = speed_in;
@@ -85,6 +95,14 @@ void Camera::setLastY(double yPos)
     lastY = yPos;
 }
 
+void Camera::setPose(glm::vec3 position_in, float yaw_in, float pitch_in)
+{
+    position = position_in;
+    yaw = yaw_in;
+    pitch = pitch_in;
+    updateCameraVectors();
+}
+
 void Camera::processKeyboard(Camera_Movement direction, double deltaTime, int speedUp)
 {
     float velocity = movementSpeed * deltaTime * speedUp;
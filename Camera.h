@@ -41,6 +41,8 @@ public:
     glm::vec3 getFront() const;
     glm::vec3 getRight() const;
     glm::vec3 getUp() const;
+    float getYaw() const;
+    float getPitch() const;
 
     //Setters
     void setSpeed(float speed_in);
@@ -49,6 +51,8 @@ public:
     //Camera will always keep track of the mouse position via this setters
     void setLastX(double xPos);
     void setLastY(double yPos);
+    //Places the camera directly, used to replay recorded paths
+    void setPose(glm::vec3 position_in, float yaw_in, float pitch_in);
 
 
     void processKeyboard(Camera_Movement direction, double deltaTime, int speedUp);
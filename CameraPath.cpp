@@ -0,0 +1,116 @@
+#include "CameraPath.h"
+
+#include <fstream>
+#include <sstream>
+#include <algorithm>
+#include <cmath>
+
+void CameraPath::addKeyframe(const CameraKeyframe& keyframe)
+{
+    keyframes.push_back(keyframe);
+}
+
+void CameraPath::record(const Camera& camera, float time)
+{
+    addKeyframe({ time, camera.getPosition(), camera.getYaw(), camera.getPitch() });
+}
+
+void CameraPath::apply(Camera& camera, float time) const
+{
+    if (keyframes.empty())
+        return;
+    if (time <= keyframes.front().time)
+    {
+        const CameraKeyframe& first = keyframes.front();
+        camera.setPose(first.position, first.yaw, first.pitch);
+        return;
+    }
+    if (time >= keyframes.back().time)
+    {
+        const CameraKeyframe& last = keyframes.back();
+        camera.setPose(last.position, last.yaw, last.pitch);
+        return;
+    }
+
+    //First keyframe after time
+    auto next = std::upper_bound(keyframes.begin(), keyframes.end(), time,
+                                 [](float t, const CameraKeyframe& keyframe) { return t < keyframe.time; });
+    const CameraKeyframe& a = *(next - 1);
+    const CameraKeyframe& b = *next;
+    float t = (b.time > a.time) ? (time - a.time) / (b.time - a.time) : 1.0f;
+
+    //Yaw wraps at 360 degrees, take the shorter way around
+    float yawDelta = b.yaw - a.yaw;
+    yawDelta -= 360.0f * std::floor((yawDelta + 180.0f) / 360.0f);
+    camera.setPose(glm::mix(a.position, b.position, t), a.yaw + yawDelta * t, glm::mix(a.pitch, b.pitch, t));
+}
+
+bool CameraPath::load(const std::string& path)
+{
+    std::ifstream file(path);
+    if (!file)
+    {
+        std::cout << "ERROR::CAMERA_PATH::FILE_NOT_SUCCESSFULLY_READ->" << path << std::endl;
+        return false;
+    }
+
+    keyframes.clear();
+    std::string line;
+    while (std::getline(file, line))
+    {
+        if (line.empty() || line[0] == '#')
+            continue;
+        std::stringstream values(line);
+        CameraKeyframe keyframe;
+        if (values >> keyframe.time >> keyframe.position.x >> keyframe.position.y >> keyframe.position.z >> keyframe.yaw >> keyframe.pitch)
+        {
+            keyframes.push_back(keyframe);
+        }
+    }
+    std::stable_sort(keyframes.begin(), keyframes.end(),
+                     [](const CameraKeyframe& a, const CameraKeyframe& b) { return a.time < b.time; });
+    return !keyframes.empty();
+}
+
+bool CameraPath::save(const std::string& path) const
+{
+    std::ofstream file(path);
+    if (!file)
+    {
+        std::cout << "ERROR::CAMERA_PATH::FILE_NOT_SUCCESSFULLY_OPENED->" << path << std::endl;
+        return false;
+    }
+
+    file << "# time x y z yaw pitch\n";
+    for (const CameraKeyframe& keyframe : keyframes)
+    {
+        file << keyframe.time << " " << keyframe.position.x << " " << keyframe.position.y << " " << keyframe.position.z
+             << " " << keyframe.yaw << " " << keyframe.pitch << "\n";
+    }
+    return (bool)file;
+}
+
+bool CameraPath::empty() const
+{
+    return keyframes.empty();
+}
+
+float CameraPath::getDuration() const
+{
+    return keyframes.empty() ? 0.0f : keyframes.back().time - keyframes.front().time;
+}
+
+const std::vector<CameraKeyframe>& CameraPath::getKeyframes() const
+{
+    return keyframes;
+}
+
+CameraPath CameraPath::defaultPath(float duration)
+{
+    //Starts at the pose of the global camera in main.cpp, flies forward while turning left and looking down
+    CameraPath path;
+    path.addKeyframe({ 0.0f, glm::vec3(0.0f, 5.0f, 5.0f), YAW, PITCH });
+    path.addKeyframe({ duration * 0.5f, glm::vec3(0.0f, 6.0f, -10.0f), YAW + 20.0f, PITCH - 5.0f });
+    path.addKeyframe({ duration, glm::vec3(-5.0f, 5.0f, -25.0f), YAW + 40.0f, PITCH });
+    return path;
+}
@@ -0,0 +1,52 @@
+#pragma once
+#ifndef CAMERA_PATH_H
+#define CAMERA_PATH_H
+
+#include <glm/glm.hpp>
+
+#include <string>
+#include <vector>
+#include <iostream>
+
+#include "Camera.h"
+
+
+struct CameraKeyframe
+{
+    //Seconds since the start of the path
+    float time;
+    glm::vec3 position;
+    float yaw;
+    float pitch;
+};
+
+/*
+    Recorded camera movement that can be replayed deterministically.
+
+    Keyframes are sampled with linear interpolation (yaw along the shorter arc), times before the
+    first or after the last keyframe hold the end poses. The text format has one keyframe per line:
+    "time x y z yaw pitch", lines starting with '#' are comments.
+*/
+class CameraPath
+{
+public:
+    //Keyframes have to be added in increasing time
+    void addKeyframe(const CameraKeyframe& keyframe);
+    void record(const Camera& camera, float time);
+    void apply(Camera& camera, float time) const;
+
+    bool load(const std::string& path);
+    bool save(const std::string& path) const;
+
+    bool empty() const;
+    float getDuration() const;
+    const std::vector<CameraKeyframe>& getKeyframes() const;
+
+    //Fly-through from the default camera pose, used when no recorded path is given
+    static CameraPath defaultPath(float duration);
+
+private:
+    std::vector<CameraKeyframe> keyframes;
+};
+
+#endif
@@ -0,0 +1,100 @@
+#include "Checkerboard.h"
+#include "FrameConstants.h"
+
+Checkerboard::Checkerboard()
+    :
+    current(0),
+    hasHistory(false),
+    frameIndex(0),
+    width(0),
+    height(0)
+{
+}
+
+void Checkerboard::create(int width_in, int height_in)
+{
+    if (!reconstructShader.isValid())
+    {
+        reconstructShader = Shader("Shaders/checkerboard/checkerboard_vertex.glsl", "Shaders/checkerboard/checkerboard_fragment.glsl");
+        reconstructShader.bindUniformBlock(FrameConstantsBuffer::BLOCK_NAME, FrameConstantsBuffer::BINDING);
+        reconstructShader.use();
+        reconstructShader.uniform<int>("field_texture").set(FIELD_UNIT);
+        reconstructShader.uniform<int>("history_texture").set(HISTORY_UNIT);
+        fieldUniform = reconstructShader.uniform<int>("checkerboard_field");
+        historyUniform = reconstructShader.uniform<int>("checkerboard_history");
+    }
+
+    release();
+    width = width_in;
+    height = height_in;
+    //The hit distances in alpha reach the far plane of the terrain, beyond half float precision
+    fieldTarget = Framebuffer((width + 1) / 2, height, {GL_RGBA32F}, false);
+    for (Framebuffer& target : reconstructed)
+        target = Framebuffer(width, height, {GL_RGBA32F}, false);
+}
+
+void Checkerboard::resize(int width_in, int height_in)
+{
+    if (width_in == width && height_in == height)
+        return;
+    create(width_in, height_in);
+}
+
+int Checkerboard::getField() const
+{
+    return 1 + frameIndex % 2;
+}
+
+const Framebuffer& Checkerboard::getFieldTarget() const
+{
+    return fieldTarget;
+}
+
+void Checkerboard::reconstruct(GLuint quad, const Framebuffer* target, GpuProfiler& profiler)
+{
+    current = 1 - current;
+    {
+        GpuProfiler::Scope pass(profiler, "checkerboard");
+        glActiveTexture(GL_TEXTURE0 + FIELD_UNIT);
+        glBindTexture(GL_TEXTURE_2D, fieldTarget.getColorTexture());
+        glActiveTexture(GL_TEXTURE0 + HISTORY_UNIT);
+        glBindTexture(GL_TEXTURE_2D, reconstructed[1 - current].getColorTexture());
+        reconstructShader.use();
+        fieldUniform.set(getField());
+        historyUniform.set(hasHistory ? 1 : 0);
+        reconstructed[current].bind();
+        glBindVertexArray(quad);
+        glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0);
+    }
+    hasHistory = true;
+    ++frameIndex;
+
+    //The reconstructed image stays as the history, the caller gets a copy
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, reconstructed[current].getID());
+    glBindFramebuffer(GL_DRAW_FRAMEBUFFER, target ? target->getID() : 0);
+    glBlitFramebuffer(0, 0, width, height, 0, 0, width, height, GL_COLOR_BUFFER_BIT, GL_NEAREST);
+    glBindFramebuffer(GL_FRAMEBUFFER, target ? target->getID() : 0);
+}
+
+void Checkerboard::resetHistory()
+{
+    hasHistory = false;
+}
+
+void Checkerboard::release()
+{
+    fieldTarget.release();
+    for (Framebuffer& target : reconstructed)
+        target.release();
+    resetHistory();
+}
+
+int Checkerboard::getWidth() const
+{
+    return width;
+}
+
+int Checkerboard::getHeight() const
+{
+    return height;
+}
@@ -0,0 +1,63 @@
+#pragma once
+#ifndef CHECKERBOARD_H
+#define CHECKERBOARD_H
+
+#include <GL/glew.h>
+
+#include "Shader.h"
+#include "Framebuffer.h"
+#include "DeferredPipeline.h"
+#include "GpuProfiler.h"
+
+
+/*
+    Checkerboard rendering of the single pass scene shaders (Shaders/checkerboard.glsl).
+
+    Every frame the scene marches only the pixels of one checkerboard field into getFieldTarget(),
+    a target of half the width whose texels the shader maps to the marched pixels (a discarded half
+    of every 2x2 quad would leave the GPU lanes idle instead of saving them). The fields alternate,
+    reconstruct() (Shaders/checkerboard/checkerboard_fragment.glsl) fills the other half from last
+    frame's image by camera reprojection or from the neighbours and copies the result to the
+    caller's render target.
+
+    Checkerboard frames run without the deferred pipeline, so its texture units are reused.
+    Like Framebuffer, it is a light handle around GL names. Call release() to free them.
+*/
+class Checkerboard
+{
+public:
+    static constexpr int FIELD_UNIT = DeferredPipeline::GBUFFER_UNIT;
+    static constexpr int HISTORY_UNIT = DeferredPipeline::SHADOW_UNIT;
+
+    Checkerboard();
+    //Builds the reconstruction program if needed and allocates the targets, needs a current context
+    void create(int width_in, int height_in);
+    void resize(int width_in, int height_in);
+    //Value of the checkerboard_field uniform of the scene shaders for this frame, 1 or 2
+    int getField() const;
+    //The scene marches its field into this target instead of the caller's one
+    const Framebuffer& getFieldTarget() const;
+    //Reconstructs the frame into target (the window if it is null) and moves on to the other field
+    void reconstruct(GLuint quad, const Framebuffer* target, GpuProfiler& profiler);
+    //The next frame is filled from its own field only
+    void resetHistory();
+    void release();
+
+    int getWidth() const;
+    int getHeight() const;
+
+private:
+    Shader reconstructShader;
+    Uniform<int> fieldUniform;
+    Uniform<int> historyUniform;
+    Framebuffer fieldTarget;
+    //The reconstructed image of this frame and of the last one
+    Framebuffer reconstructed[2];
+    int current;
+    bool hasHistory;
+    int frameIndex;
+    int width;
+    int height;
+};
+
+#endif
@@ -0,0 +1,85 @@
+#include "ConePrepass.h"
+
+constexpr int ConePrepass::TILE_SIZES[];
+
+void ConePrepass::Uniforms::resolve(const Shader& shader)
+{
+    levelTile = shader.uniform<int>("cone_level_tile");
+    startTile = shader.uniform<int>("cone_start_tile");
+    startTexture = shader.uniform<int>("cone_start_texture");
+    shader.use();
+    startTexture.set(TEXTURE_UNIT);
+}
+
+ConePrepass::ConePrepass()
+    :
+    width(0),
+    height(0)
+{
+}
+
+void ConePrepass::create(int width_in, int height_in)
+{
+    release();
+    width = width_in;
+    height = height_in;
+    for (int level = 0; level < LEVEL_COUNT; ++level)
+    {
+        int tile = TILE_SIZES[level];
+        //Partial tiles at the right and top border get a texel too
+        levels.push_back(Framebuffer((width + tile - 1) / tile, (height + tile - 1) / tile, {GL_R32F}, false));
+    }
+}
+
+void ConePrepass::resize(int width_in, int height_in)
+{
+    if (width_in == width && height_in == height)
+        return;
+    create(width_in, height_in);
+}
+
+void ConePrepass::render(const Shader& shader, const Uniforms& uniforms, GLuint quad) const
+{
+    shader.use();
+    glBindVertexArray(quad);
+    glActiveTexture(GL_TEXTURE0 + TEXTURE_UNIT);
+    for (int level = 0; level < (int)levels.size(); ++level)
+    {
+        //The first level marches from the camera, the others from the level before
+        if (level > 0)
+            glBindTexture(GL_TEXTURE_2D, levels[level - 1].getColorTexture());
+        uniforms.startTile.set(level > 0 ? TILE_SIZES[level - 1] : 0);
+        uniforms.levelTile.set(TILE_SIZES[level]);
+
+        levels[level].bind();
+        glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0);
+    }
+
+    glBindTexture(GL_TEXTURE_2D, levels.empty() ? 0 : levels.back().getColorTexture());
+    uniforms.startTile.set(levels.empty() ? 0 : TILE_SIZES[levels.size() - 1]);
+    uniforms.levelTile.set(0);
+}
+
+void ConePrepass::disable(const Shader& shader, const Uniforms& uniforms)
+{
+    shader.use();
+    uniforms.levelTile.set(0);
+    uniforms.startTile.set(0);
+}
+
+void ConePrepass::release()
+{
+    for (Framebuffer& level : levels)
+        level.release();
+    levels.clear();
+}
+
+int ConePrepass::getWidth() const
+{
+    return width;
+}
+
+int ConePrepass::getHeight() const
+{
+    return height;
+}
@@ -0,0 +1,66 @@
+#pragma once
+#ifndef CONE_PREPASS_H
+#define CONE_PREPASS_H
+
+#include <GL/glew.h>
+
+#include <vector>
+
+#include "Shader.h"
+#include "Framebuffer.h"
+
+
+/*
+    Hierarchical cone marching prepass of the scene shaders (Shaders/cone_prepass.glsl).
+
+    Every level draws the scene shader over a grid of tiles into an R32F texture. A fragment marches
+    one cone that encloses the rays of all pixels of its tile and stores the distance where the cone
+    first touches a surface; no ray of the tile can hit anything closer. Levels go from coarse to fine
+    (TILE_SIZES) and each one starts its cones from the distances of the previous level, so the fine
+    level only marches the space close to the surfaces. The full resolution ray_march then starts
+    from the distance of its tile instead of the camera.
+
+    Like Framebuffer, it is a light handle around GL names. Call release() to free them.
+*/
+class ConePrepass
+{
+public:
+    //Tile widths in pixels, every tile lies in one tile of the previous level
+    static constexpr int TILE_SIZES[] = { 8, 2 };
+    static constexpr int LEVEL_COUNT = 2;
+    //Texture unit of the start distances, above the units of the scene textures
+    static constexpr int TEXTURE_UNIT = 8;
+
+    //Uniforms of cone_prepass.glsl in one scene shader
+    struct Uniforms
+    {
+        Uniform<int> levelTile;
+        Uniform<int> startTile;
+        Uniform<int> startTexture;
+        void resolve(const Shader& shader);
+    };
+
+    ConePrepass();
+    //Allocates the levels for a full resolution image of the given size, needs a current context
+    void create(int width_in, int height_in);
+    void resize(int width_in, int height_in);
+    /*
+        Renders the levels with the shader; the frame constants and scene textures have to be bound.
+        Leaves the finest level bound and selected for the full resolution draw,
+        the caller binds its own render target again afterwards.
+    */
+    void render(const Shader& shader, const Uniforms& uniforms, GLuint quad) const;
+    //Lets the full resolution draw march from the camera again
+    static void disable(const Shader& shader, const Uniforms& uniforms);
+    void release();
+
+    int getWidth() const;
+    int getHeight() const;
+
+private:
+    std::vector<Framebuffer> levels;
+    int width;
+    int height;
+};
+
+#endif
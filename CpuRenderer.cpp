@@ -0,0 +1,238 @@
+#include "CpuRenderer.h"
+
+#include <cmath>
+#include <algorithm>
+
+//Same constants as the fragment shaders
+static constexpr int MAX_STEPS = 256;
+static constexpr float EPSILON = 0.001f;
+//Tiles are small enough to balance well and large enough to keep a core on coherent rays
+static constexpr int TILE_SIZE = 16;
+//Primary rays are marched in packets of 4 x 2 (AVX2) or 4 x 4 (AVX-512) pixels
+static constexpr int PACKET_WIDTH = 4;
+static constexpr int PACKET_HEIGHT = PACKET_SIZE / PACKET_WIDTH;
+
+/*
+    March the rays of the packet from their origins towards their directions, like ray_march.
+    A lane stops once it hits or leaves the scene, the packet retires when every lane has stopped.
+ 
+    Note: If there is no hit object.x > MAX_DIST in that lane
+*/
+static void rayMarchPacket(const CpuScene& scene, RayPacket& ray)
+{
+    PacketFloat maxDistance = PacketFloat(scene.getMaxDistance());
+    PacketFloat epsilon = PacketFloat(EPSILON);
+    PacketFloat one = PacketFloat(1.0f);
+    //Over-relaxation state per lane, see ray_march in the shaders
+    PacketFloat omega = PacketFloat(scene.getRelaxation());
+    PacketFloat previousRadius = PacketFloat(0.0f);
+    PacketFloat stepLength = PacketFloat(0.0f);
+    ray.object = PacketVec2(PacketFloat(0.0f), PacketFloat(0.0f));
+    //All lanes active
+    ray.active = maxDistance == maxDistance;
+    for (int i = 0; i < MAX_STEPS; ++i)
+    {
+        PacketVec3 p = ray.origin + ray.direction * ray.object.x;
+        PacketVec2 hit = scene.closestObjectPacket(p);
+        PacketFloat radius = abs(hit.x);
+        PacketMask overshoot = (omega > one) & (radius + previousRadius < stepLength);
+        stepLength = select(overshoot, stepLength - omega * stepLength, hit.x * omega);
+        omega = select(overshoot, one, omega);
+
+        ray.object.y = select(ray.active & ~overshoot, hit.y, ray.object.y);
+        ray.active = ray.active & ~(~overshoot & ((radius < epsilon) | (ray.object.x > maxDistance)));
+        previousRadius = radius;
+        ray.object.x = select(ray.active, ray.object.x + stepLength, ray.object.x);
+        if (simd::none(ray.active))
+        {
+            break;
+        }
+    }
+}
+
+/*
+    Exact gradient of the scene's distance function, one evaluation with dual numbers.
+    Central differences like get_normal where it vanishes (the inside of a clamped distance).
+*/
+static glm::vec3 getNormal(const CpuScene& scene, glm::vec3 p)
+{
+    glm::vec3 gradient = glm::vec3(scene.closestObjectGradient(p));
+    float length = glm::length(gradient);
+    if (length > 0.0f && std::isfinite(length))
+    {
+        return gradient / length;
+    }
+    return glm::normalize(glm::vec3(
+        scene.closestObject(glm::vec3(p.x + EPSILON, p.y, p.z)).x - scene.closestObject(glm::vec3(p.x - EPSILON, p.y, p.z)).x,
+        scene.closestObject(glm::vec3(p.x, p.y + EPSILON, p.z)).x - scene.closestObject(glm::vec3(p.x, p.y - EPSILON, p.z)).x,
+        scene.closestObject(glm::vec3(p.x, p.y, p.z + EPSILON)).x - scene.closestObject(glm::vec3(p.x, p.y, p.z - EPSILON)).x));
+}
+
+static float getSoftShadow(const CpuScene& scene, glm::vec3 p, glm::vec3 lightPos)
+{
+    float res = 1.0f;
+    float dist = 0.01f;
+    float lightSize = scene.getShadowLightSize();
+    for (int i = 0; i < MAX_STEPS; ++i)
+    {
+        float hit = scene.closestObject(p + lightPos * dist).x;
+        res = std::min(res, hit / (dist * lightSize));
+        dist += hit;
+        if (hit < 0.0001f || dist > 60.0f)
+        {
+            break;
+        }
+    }
+    return glm::clamp(res, 0.0f, 1.0f);
+}
+
+static float getAmbientOcclusion(const CpuScene& scene, glm::vec3 p, glm::vec3 normal)
+{
+    float occ = 0.0f;
+    float weight = 1.0f;
+    for (int i = 0; i < 8; ++i)
+    {
+        float len = 0.01f + 0.02f * float(i * i);
+        float dist = scene.closestObject(p + normal * len).x;
+        occ += (len - dist) * weight;
+        weight *= 0.85f;
+    }
+    return 1.0f - glm::clamp(0.6f * occ, 0.0f, 1.0f);
+}
+
+static glm::vec3 getLight(const CpuScene& scene, glm::vec3 p, glm::vec3 rd, float id)
+{
+    glm::vec3 lightPos = scene.getLightPosition();
+    glm::vec3 L = glm::normalize(lightPos - p);
+    glm::vec3 N = getNormal(scene, p);
+    glm::vec3 V = -rd;
+    glm::vec3 R = glm::reflect(-L, N);
+
+    glm::vec3 color = scene.getMaterial(p, id, N);
+
+    glm::vec3 specColor = glm::vec3(0.5f);
+    glm::vec3 specular = specColor * std::pow(glm::clamp(glm::dot(R, V), 0.0f, 1.0f), 10.0f);
+    glm::vec3 diffuse = color * glm::clamp(glm::dot(L, N), 0.0f, 1.0f);
+    glm::vec3 ambient = color * 0.05f;
+    glm::vec3 fresnel = 0.25f * color * std::pow(std::max(1.0f + glm::dot(rd, N), 0.0f), 3.0f);
+
+    //Shadows
+    float shadow = getSoftShadow(scene, p + N * 0.02f, glm::normalize(lightPos));
+    //Ambient Occlusion
+    float occ = getAmbientOcclusion(scene, p, N);
+    //The light that is reflected back from the illuminated objects
+    glm::vec3 reflectedBack = 0.05f * color * glm::clamp(glm::dot(N, L), 0.0f, 1.0f);
+
+    //Shadow affects diffuse and specular
+    //Occlusion affects specular ambient and fresnel
+    return shadow * (diffuse + specular * occ) + (reflectedBack + ambient + fresnel) * occ;
+}
+
+//Shades a ray marched to object
+static glm::vec3 renderRay(const CpuScene& scene, glm::vec3 ro, glm::vec3 rd, glm::vec2 object)
+{
+    glm::vec3 col = glm::vec3(0.0f);
+
+    glm::vec3 background = glm::vec3(0.5f, 0.8f, 0.9f);
+
+    //If there is a hit
+    if (object.x < scene.getMaxDistance())
+    {
+        glm::vec3 p = ro + object.x * rd;
+        col += getLight(scene, p, rd, object.y);
+        //Fog
+        if (scene.hasFog())
+        {
+            col = glm::mix(col, background, 1.0f - std::exp(-1e-6f * object.x * object.x));
+        }
+    }
+    else
+    {
+        col += background - std::max(0.9f * rd.y, 0.0f);
+    }
+    return col;
+}
+
+CpuRenderer::CpuRenderer(int threadCount)
+    :
+    pool(threadCount)
+{
+}
+
+void CpuRenderer::render(const CpuScene& scene, const Camera& camera, int width, int height, std::vector<unsigned char>& pixels)
+{
+    pixels.resize((size_t)width * height * 3);
+
+    int tilesX = (width + TILE_SIZE - 1) / TILE_SIZE;
+    int tilesY = (height + TILE_SIZE - 1) / TILE_SIZE;
+    pool.parallelFor(tilesX * tilesY, [&](int tile, int)
+    {
+        renderTile(scene, camera, tile % tilesX, tile / tilesX, width, height, pixels);
+    });
+}
+
+int CpuRenderer::getThreadCount() const
+{
+    return pool.getThreadCount();
+}
+
+void CpuRenderer::renderTile(const CpuScene& scene, const Camera& camera, int tileX, int tileY,
+                             int width, int height, std::vector<unsigned char>& pixels) const
+{
+    glm::vec2 aspectRatio = glm::vec2((float)width / height, 1.0f);
+    glm::vec3 ro = camera.getPosition();
+    glm::mat3 lookAt = glm::mat3(camera.getRight(), camera.getUp(), -camera.getFront());
+
+    int xEnd = std::min((tileX + 1) * TILE_SIZE, width);
+    int yEnd = std::min((tileY + 1) * TILE_SIZE, height);
+    for (int py = tileY * TILE_SIZE; py < yEnd; py += PACKET_HEIGHT)
+    {
+        for (int px = tileX * TILE_SIZE; px < xEnd; px += PACKET_WIDTH)
+        {
+            //Lanes outside the image repeat the last pixel and are discarded
+            alignas(64) float dx[PACKET_SIZE], dy[PACKET_SIZE], dz[PACKET_SIZE];
+            glm::vec3 directions[PACKET_SIZE];
+            for (int i = 0; i < PACKET_SIZE; ++i)
+            {
+                int x = std::min(px + i % PACKET_WIDTH, width - 1);
+                int y = std::min(py + i / PACKET_WIDTH, height - 1);
+                //Fragment centers, uv starts at the bottom left like the screen quad's texture coordinates
+                glm::vec2 uv = glm::vec2((x + 0.5f) / width, (y + 0.5f) / height);
+                directions[i] = lookAt * glm::normalize(glm::vec3(aspectRatio * (uv - 0.5f), -1.0f));
+                dx[i] = directions[i].x;
+                dy[i] = directions[i].y;
+                dz[i] = directions[i].z;
+            }
+
+            RayPacket ray;
+            ray.origin = PacketVec3(PacketFloat(ro.x), PacketFloat(ro.y), PacketFloat(ro.z));
+            ray.direction = PacketVec3(PacketFloat::load(dx), PacketFloat::load(dy), PacketFloat::load(dz));
+            rayMarchPacket(scene, ray);
+
+            alignas(64) float distances[PACKET_SIZE], ids[PACKET_SIZE];
+            ray.object.x.store(distances);
+            ray.object.y.store(ids);
+            for (int i = 0; i < PACKET_SIZE; ++i)
+            {
+                int x = px + i % PACKET_WIDTH;
+                int y = py + i / PACKET_WIDTH;
+                if (x >= xEnd || y >= yEnd)
+                {
+                    continue;
+                }
+
+                //Shading stays per pixel, secondary rays diverge too much for packets
+                glm::vec3 col = renderRay(scene, ro, directions[i], glm::vec2(distances[i], ids[i]));
+                //Gamma Correction
+                col = glm::pow(glm::max(col, glm::vec3(0.0f)), glm::vec3(0.4545f));
+
+                //Rows are stored top to bottom
+                size_t index = ((size_t)(height - 1 - y) * width + x) * 3;
+                for (int c = 0; c < 3; ++c)
+                {
+                    pixels[index + c] = (unsigned char)(glm::clamp(col[c], 0.0f, 1.0f) * 255.0f + 0.5f);
+                }
+            }
+        }
+    }
+}
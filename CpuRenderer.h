@@ -0,0 +1,40 @@
+#pragma once
+#ifndef CPU_RENDERER_H
+#define CPU_RENDERER_H
+
+#include <glm/glm.hpp>
+
+#include <vector>
+
+#include "Camera.h"
+#include "CpuScenes.h"
+#include "WorkStealingPool.h"
+
+
+/*
+    Reference ray marcher running on the CPU.
+ 
+    Mirrors ray_march, get_normal, get_soft_shadow, get_ambient_occlusion and get_light of the
+    scene fragment shaders so GPU-less machines produce the same images as the GL path.
+    The normals are the exact gradients of CpuScene::closestObjectGradient instead of differences.
+    The image is split into square tiles which the work stealing pool spreads over all cores.
+*/
+class CpuRenderer
+{
+public:
+    //0 threads means one per hardware thread
+    CpuRenderer(int threadCount = 0);
+
+    //Renders the scene as seen from the camera. pixels receives 8-bit RGB, top row first.
+    void render(const CpuScene& scene, const Camera& camera, int width, int height, std::vector<unsigned char>& pixels);
+    int getThreadCount() const;
+
+private:
+    void renderTile(const CpuScene& scene, const Camera& camera, int tileX, int tileY,
+                    int width, int height, std::vector<unsigned char>& pixels) const;
+
+private:
+    WorkStealingPool pool;
+};
+
+#endif
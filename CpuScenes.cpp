@@ -0,0 +1,903 @@
+#include "CpuScenes.h"
+
+#include <cmath>
+
+#include "hg_sdf.h"
+#include "Dual.h"
+
+using namespace hg;
+
+using vec2f = hg::vec2<float>;
+using vec3f = hg::vec3<float>;
+
+/*
+    Helpers shared by the scene shaders
+*/
+
+static vec3f toHg(const glm::vec3& v)
+{
+    return vec3f(v.x, v.y, v.z);
+}
+
+static glm::vec3 toGlm(const vec3f& v)
+{
+    return glm::vec3(v.x, v.y, v.z);
+}
+
+//GLSL sign, returns 0 for 0
+template<typename T>
+static T signum(T x)
+{
+    return select(x > T(0.0f), T(1.0f), select(x < T(0.0f), T(-1.0f), T(0.0f)));
+}
+
+//GLSL step(edge, x) with scalar x
+static glm::vec2 step(glm::vec2 edge, float x)
+{
+    return glm::vec2(x < edge.x ? 0.0f : 1.0f, x < edge.y ? 0.0f : 1.0f);
+}
+
+/*
+    Triplanar texture mapping.
+ 
+    The method accumulates the texture colors in xy-xz-yz planes seperately by multiplying
+    the texture color in the corresponding plane with its normal.
+*/
+static glm::vec3 triplanar(const CpuTexture& tex, glm::vec3 p, glm::vec3 normal)
+{
+    normal = glm::abs(normal);
+    normal = glm::pow(normal, glm::vec3(5.0f));
+    normal /= normal.x + normal.y + normal.z;
+    return tex.sample(glm::vec2(p.x, p.y) * 0.5f + 0.5f) * normal.z +
+           tex.sample(glm::vec2(p.x, p.z) * 0.5f + 0.5f) * normal.y +
+           tex.sample(glm::vec2(p.y, p.z) * 0.5f + 0.5f) * normal.x;
+}
+
+/*
+    Texture reads are per point, the packet versions sample lane by lane.
+*/
+
+static float bumpMapping(const CpuTexture& tex, const vec3f& p, const vec3f& n, float dist, float factor, float scale)
+{
+    float bump = 0.0f;
+    if (dist < 0.1f)
+    {
+        bump += factor * triplanar(tex, toGlm(p) * scale, toGlm(n)).x;
+    }
+    return bump;
+}
+
+static PacketFloat bumpMapping(const CpuTexture& tex, const PacketVec3& p, const PacketVec3& n, PacketFloat dist, float factor, float scale)
+{
+    //Only the lanes close to the surface sample the texture
+    int lanes = simd::bits(dist < PacketFloat(0.1f));
+    if (lanes == 0)
+    {
+        return PacketFloat(0.0f);
+    }
+    alignas(64) float bump[PACKET_SIZE] = {};
+    for (int i = 0; i < PACKET_SIZE; ++i)
+    {
+        if (lanes >> i & 1)
+        {
+            bump[i] = factor * triplanar(tex, getLane(p, i) * scale, getLane(n, i)).x;
+        }
+    }
+    return PacketFloat::load(bump);
+}
+
+//Red channel of a texture read, the noise textures are grayscale
+static float sampleRed(const CpuTexture& tex, const vec2f& uv)
+{
+    return tex.sample(glm::vec2(uv.x, uv.y)).x;
+}
+
+static PacketFloat sampleRed(const CpuTexture& tex, const PacketVec2& uv)
+{
+    alignas(64) float u[PACKET_SIZE], v[PACKET_SIZE];
+    uv.x.store(u);
+    uv.y.store(v);
+    for (int i = 0; i < PACKET_SIZE; ++i)
+    {
+        u[i] = tex.sample(glm::vec2(u[i], v[i])).x;
+    }
+    return PacketFloat::load(u);
+}
+
+/*
+    Texture reads of the dual numbers follow the derivatives of the bilinear filter,
+    so the bump maps shape the gradients like they shape the differences of get_normal.
+*/
+
+template<typename D, ad::EnableIfDual<D> = 0>
+static D sampleRed(const CpuTexture& tex, const hg::vec2<D>& uv)
+{
+    glm::vec3 du, dv, duv;
+    glm::vec3 color = tex.sample(glm::vec2(uv.x.v, uv.y.v), du, dv, duv);
+    return ad::bilinear(color.x, du.x, dv.x, duv.x, uv.x, uv.y);
+}
+
+//Red channel of triplanar()
+template<typename D, ad::EnableIfDual<D> = 0>
+static D triplanarRed(const CpuTexture& tex, const hg::vec3<D>& p, hg::vec3<D> normal)
+{
+    normal = abs(normal);
+    normal = hg::vec3<D>(pow(normal.x, D(5.0f)), pow(normal.y, D(5.0f)), pow(normal.z, D(5.0f)));
+    normal = normal / (normal.x + normal.y + normal.z);
+    hg::vec2<D> half = hg::vec2<D>(D(0.5f));
+    return sampleRed(tex, hg::vec2<D>(p.x, p.y) * D(0.5f) + half) * normal.z +
+           sampleRed(tex, hg::vec2<D>(p.x, p.z) * D(0.5f) + half) * normal.y +
+           sampleRed(tex, hg::vec2<D>(p.y, p.z) * D(0.5f) + half) * normal.x;
+}
+
+template<typename D, ad::EnableIfDual<D> = 0>
+static D bumpMapping(const CpuTexture& tex, const hg::vec3<D>& p, const hg::vec3<D>& n, D dist, float factor, float scale)
+{
+    if (!(dist < D(0.1f)))
+    {
+        return D(0.0f);
+    }
+    return D(factor) * triplanarRed(tex, p * D(scale), n);
+}
+
+//The coordinates of p are the variables the gradient is taken for
+static hg::vec3<ad::Dual> gradientVariables(const glm::vec3& p)
+{
+    return hg::vec3<ad::Dual>(ad::Dual(p.x, vec3f(1.0f, 0.0f, 0.0f)),
+                              ad::Dual(p.y, vec3f(0.0f, 1.0f, 0.0f)),
+                              ad::Dual(p.z, vec3f(0.0f, 0.0f, 1.0f)));
+}
+
+static glm::vec4 gradientOf(const ad::Dual& dist)
+{
+    return glm::vec4(dist.d.x, dist.d.y, dist.d.z, dist.v);
+}
+
+//p moved along u by e1 and along v by e2
+static hg::vec3<ad::HyperDual> directionVariables(const glm::vec3& p, const glm::vec3& u, const glm::vec3& v)
+{
+    return hg::vec3<ad::HyperDual>(ad::HyperDual(p.x, u.x, v.x, 0.0f),
+                                   ad::HyperDual(p.y, u.y, v.y, 0.0f),
+                                   ad::HyperDual(p.z, u.z, v.z, 0.0f));
+}
+
+/*
+    hg_sdf utility variants which also includes the id information
+*/
+
+template<typename T>
+static hg::vec2<T> fOpUnionID(const hg::vec2<T>& res1, const hg::vec2<T>& res2)
+{
+    return select(res1.x < res2.x, res1, res2);
+}
+
+template<typename T>
+static hg::vec2<T> fOpDifferenceColumnsID(const hg::vec2<T>& res1, const hg::vec2<T>& res2, float r, float n)
+{
+    T dist = fOpDifferenceColumns(res1.x, res2.x, r, n);
+    return hg::vec2<T>(dist, select(res1.x > -res2.x, res1.y, res2.y));
+}
+
+template<typename T>
+static hg::vec2<T> fOpUnionStairsID(const hg::vec2<T>& res1, const hg::vec2<T>& res2, float r, float n)
+{
+    T dist = fOpUnionStairs(res1.x, res2.x, r, n);
+    return hg::vec2<T>(dist, select(res1.x < res2.x, res1.y, res2.y));
+}
+
+template<typename T>
+static hg::vec2<T> fOpUnionChamferID(const hg::vec2<T>& res1, const hg::vec2<T>& res2, float r)
+{
+    T dist = fOpUnionChamfer(res1.x, res2.x, r);
+    return hg::vec2<T>(dist, select(res1.x < res2.x, res1.y, res2.y));
+}
+
+//Material cases every scene shader shares
+static bool commonMaterial(glm::vec3 p, int id, glm::vec3& m)
+{
+    switch (id)
+    {
+        case 1:
+            m = glm::vec3(0.9f, 0.0f, 0.0f);
+            return true;
+        case 2:
+            m = glm::vec3(0.2f + 0.4f * mod(std::floor(p.x) + std::floor(p.z), 2.0f));
+            return true;
+        case 4:
+        {
+            glm::vec2 i = step(glm::vec2(fract(0.5f * p.x), fract(0.5f * p.z)), 1.0f / 10.0f);
+            m = ((1.0f - i.x) * (1.0f - i.y)) * glm::vec3(0.37f, 0.12f, 0.0f);
+            return true;
+        }
+        default:
+            return false;
+    }
+}
+
+
+/*
+    CpuScene
+*/
+
+CpuScene::CpuScene(float maxDistance_in, glm::vec3 lightPosition_in, float shadowLightSize_in, bool fog_in)
+    :
+    time(0.0f),
+    relaxation(1.0f),
+    maxDistance(maxDistance_in),
+    lightPosition(lightPosition_in),
+    shadowLightSize(shadowLightSize_in),
+    fog(fog_in)
+{
+}
+
+void CpuScene::setTime(float time_in)
+{
+    time = time_in;
+}
+
+void CpuScene::setRelaxation(float relaxation_in)
+{
+    relaxation = relaxation_in;
+}
+
+float CpuScene::getRelaxation() const
+{
+    return relaxation;
+}
+
+float CpuScene::getMaxDistance() const
+{
+    return maxDistance;
+}
+
+glm::vec3 CpuScene::getLightPosition() const
+{
+    return lightPosition;
+}
+
+float CpuScene::getShadowLightSize() const
+{
+    return shadowLightSize;
+}
+
+bool CpuScene::hasFog() const
+{
+    return fog;
+}
+
+PacketVec2 CpuScene::closestObjectPacket(const PacketVec3& p) const
+{
+    alignas(64) float x[PACKET_SIZE], y[PACKET_SIZE], z[PACKET_SIZE];
+    alignas(64) float dist[PACKET_SIZE], id[PACKET_SIZE];
+    p.x.store(x);
+    p.y.store(y);
+    p.z.store(z);
+    for (int i = 0; i < PACKET_SIZE; ++i)
+    {
+        glm::vec2 hit = closestObject(glm::vec3(x[i], y[i], z[i]));
+        dist[i] = hit.x;
+        id[i] = hit.y;
+    }
+    return PacketVec2(PacketFloat::load(dist), PacketFloat::load(id));
+}
+
+glm::vec4 CpuScene::closestObjectGradient(const glm::vec3& p) const
+{
+    const float h = 0.001f;
+    return glm::vec4(
+        (closestObject(glm::vec3(p.x + h, p.y, p.z)).x - closestObject(glm::vec3(p.x - h, p.y, p.z)).x) / (2.0f * h),
+        (closestObject(glm::vec3(p.x, p.y + h, p.z)).x - closestObject(glm::vec3(p.x, p.y - h, p.z)).x) / (2.0f * h),
+        (closestObject(glm::vec3(p.x, p.y, p.z + h)).x - closestObject(glm::vec3(p.x, p.y, p.z - h)).x) / (2.0f * h),
+        closestObject(p).x);
+}
+
+float CpuScene::closestObjectSecondDerivative(const glm::vec3& p, const glm::vec3& u, const glm::vec3& v) const
+{
+    const float h = 0.01f;
+    return (closestObject(p + h * (u + v)).x - closestObject(p + h * (u - v)).x
+            - closestObject(p - h * (u - v)).x + closestObject(p - h * (u + v)).x) / (4.0f * h * h);
+}
+
+void CpuScene::loadTextures(const std::vector<const char*>& texturePaths)
+{
+    textures.resize(texturePaths.size());
+    for (int i = 0; i < (int)texturePaths.size(); ++i)
+    {
+        textures[i].load(texturePaths[i]);
+    }
+}
+
+const CpuTexture& CpuScene::texture(int index) const
+{
+    //Unbound samplers read black in GL as well
+    static const CpuTexture unbound;
+    return (index < (int)textures.size()) ? textures[index] : unbound;
+}
+
+
+/*
+    Building scene (Shaders/scene1)
+*/
+
+static constexpr float BUILDING_CUBE_SCALE = 1.0f / 6.0f;
+static constexpr float BUILDING_ROOF_SCALE = 0.15f;
+static constexpr float BUILDING_PEDESTAL_SCALE = 0.3f;
+static constexpr float BUILDING_FLOOR_SCALE = 0.15f;
+static constexpr float BUILDING_SPHERE_SCALE = 0.2f;
+static constexpr float BUILDING_WALL_SCALE = 0.12f;
+
+static constexpr float BUILDING_ROOF_BUMP_FACTOR = 0.31f;
+static constexpr float BUILDING_SPHERE_BUMP_FACTOR = 0.21f;
+static constexpr float BUILDING_WALL_BUMP_FACTOR = 0.06f;
+
+BuildingScene::BuildingScene(const std::vector<const char*>& texturePaths)
+    :
+    CpuScene(1500.0f, glm::vec3(20.0f, 40.0f, 30.0f), 0.03f, true)
+{
+    loadTextures(texturePaths);
+}
+
+template<typename T>
+hg::vec2<T> BuildingScene::getPedestal(hg::vec3<T> p) const
+{
+    // box 1
+    p.y += T(13.8f);
+    T box1 = fBoxCheap(p, vec3f(8.0f, 0.4f, 8.0f));
+    // box 2
+    p.y -= T(6.4f);
+    T box2 = fBoxCheap(p, vec3f(7.0f, 6.0f, 7.0f));
+    // box 3
+    pMirrorOctant(p.z, p.x, vec2f(7.5f, 7.5f));
+    T box3 = fBoxCheap(p, vec3f(5.0f, 4.0f, 1.0f));
+    // res
+    T resDist = box1;
+    resDist = min(resDist, box2);
+    resDist = fOpDifferenceColumns(resDist, box3, 1.9f, 10.0f);
+    return hg::vec2<T>(resDist, T(7.0f));
+}
+
+template<typename T>
+void BuildingScene::translateSphere(hg::vec3<T>& p) const
+{
+    p.y -= T(35.4f);
+}
+
+template<typename T>
+void BuildingScene::rotateSphere(hg::vec3<T>& p) const
+{
+    pR(p.x, p.z, 0.3f * time);
+}
+
+template<typename T>
+hg::vec2<T> BuildingScene::sdf(hg::vec3<T> p) const
+{
+    hg::vec3<T> op = p;
+    // plane
+    hg::vec2<T> plane = hg::vec2<T>(fPlane(p, vec3f(0.0f, 1.0f, 0.0f), 14.0f), T(6.0f));
+
+    // pedestal
+    hg::vec3<T> pp = p;
+    pp.y -= T(25.4f);
+    pMirrorOctant(pp.x, pp.z, vec2f(80.0f, 80.0f));
+    pR(pp.x, pp.z, T(0.1f) * pp.y);
+    hg::vec2<T> pedestal = getPedestal(pp);
+    // sphere
+    hg::vec3<T> ps = p;
+    translateSphere(ps);
+    rotateSphere(ps);
+    pMirror(ps.x, 80.0f);
+    pMirror(ps.z, 80.0f);
+    T sphereDist = fSphere(ps, 6.0f);
+    sphereDist += bumpMapping(texture(4), ps, ps + BUILDING_SPHERE_BUMP_FACTOR,
+                              sphereDist, BUILDING_SPHERE_BUMP_FACTOR, BUILDING_SPHERE_SCALE);
+    sphereDist += T(BUILDING_SPHERE_BUMP_FACTOR);
+    hg::vec2<T> sphere = hg::vec2<T>(sphereDist, T(10.0f));
+
+    // manipulation operators
+    pMirrorOctant(p.x, p.z, vec2f(80.0f, 80.0f));
+    pMirrorOctant(p.x, p.z, vec2f(80.0f, 80.0f));
+    pMirror(p.x, 20.0f);
+    pMirrorOctant(p.x, p.z, vec2f(80.0f, 80.0f));
+    p.x = -abs(p.x) + T(20.0f);
+    pMirror(p.x, 20.0f);
+    pMod1(p.z, 15.0f);
+
+    // roof
+    hg::vec3<T> pr = p;
+    pr.y -= T(15.7f);
+    pR(pr.x, pr.y, 0.6f);
+    pr.x -= T(18.0f);
+    T roofDist = fBox2Cheap(hg::vec2<T>(pr.x, pr.y), vec2f(20.0f, 0.5f));
+    roofDist -= bumpMapping(texture(5), p, p - BUILDING_ROOF_BUMP_FACTOR,
+                            roofDist, BUILDING_ROOF_BUMP_FACTOR, BUILDING_ROOF_SCALE);
+    roofDist += T(BUILDING_ROOF_BUMP_FACTOR);
+    hg::vec2<T> roof = hg::vec2<T>(roofDist, T(8.0f));
+
+    // box
+    hg::vec2<T> box = hg::vec2<T>(fBoxCheap(p, vec3f(3.0f, 9.0f, 4.0f)), T(7.0f));
+
+    // cylinder
+    hg::vec3<T> pc = p;
+    pc.y -= T(9.0f);
+    hg::vec2<T> cylinder = hg::vec2<T>(fCylinder(hg::vec3<T>(pc.y, pc.x, pc.z), 4.0f, 3.0f), T(7.0f));
+
+    // wall
+    T wallDist = fBox2Cheap(hg::vec2<T>(p.x, p.y), vec2f(1.0f, 15.0f));
+    wallDist -= bumpMapping(texture(1), op, op + BUILDING_WALL_BUMP_FACTOR,
+                            wallDist, BUILDING_WALL_BUMP_FACTOR, BUILDING_WALL_SCALE);
+    wallDist += T(BUILDING_WALL_BUMP_FACTOR);
+    hg::vec2<T> wall = hg::vec2<T>(wallDist, T(7.0f));
+
+    // result
+    hg::vec2<T> res;
+    res = fOpUnionID(box, cylinder);
+    res = fOpDifferenceColumnsID(wall, res, 0.6f, 3.0f);
+    res = fOpUnionChamferID(res, roof, 0.6f);
+    res = fOpUnionStairsID(res, plane, 4.0f, 5.0f);
+    res = fOpUnionID(res, sphere);
+    res = fOpUnionStairsID(res, pedestal, 4.0f, 5.0f);
+    return res;
+}
+
+glm::vec2 BuildingScene::closestObject(const glm::vec3& p) const
+{
+    vec2f res = sdf(toHg(p));
+    return glm::vec2(res.x, res.y);
+}
+
+PacketVec2 BuildingScene::closestObjectPacket(const PacketVec3& p) const
+{
+    return sdf(p);
+}
+
+glm::vec4 BuildingScene::closestObjectGradient(const glm::vec3& p) const
+{
+    return gradientOf(sdf(gradientVariables(p)).x);
+}
+
+float BuildingScene::closestObjectSecondDerivative(const glm::vec3& p, const glm::vec3& u, const glm::vec3& v) const
+{
+    return sdf(directionVariables(p, u, v)).x.e12;
+}
+
+glm::vec3 BuildingScene::getMaterial(glm::vec3 p, float id, glm::vec3 normal) const
+{
+    glm::vec3 m;
+    if (commonMaterial(p, (int)id, m))
+        return m;
+
+    switch ((int)id)
+    {
+        case 3:
+            m = glm::vec3(0.7f, 0.8f, 0.9f);
+            break;
+        // cube
+        case 5:
+            m = triplanar(texture(0), p * BUILDING_CUBE_SCALE, normal);
+            break;
+        // floor
+        case 6:
+            m = triplanar(texture(0), p * BUILDING_FLOOR_SCALE, normal);
+            break;
+        // walls
+        case 7:
+            m = triplanar(texture(1), p * BUILDING_WALL_SCALE, normal);
+            break;
+        // roof
+        case 8:
+            m = triplanar(texture(2), p * BUILDING_ROOF_SCALE, normal);
+            break;
+        // pedestal
+        case 9:
+            m = triplanar(texture(3), p * BUILDING_PEDESTAL_SCALE, normal);
+            break;
+        // sphere
+        case 10:
+        {
+            vec3f ps = toHg(p);
+            vec3f n = toHg(normal);
+            translateSphere(ps);
+            rotateSphere(ps);
+            rotateSphere(n);
+            m = triplanar(texture(4), toGlm(ps) * BUILDING_SPHERE_SCALE, toGlm(n));
+            break;
+        }
+        // roof bump
+        case 11:
+            m = triplanar(texture(5), p * BUILDING_ROOF_SCALE, normal);
+            break;
+        default:
+            m = glm::vec3(0.4f);
+            break;
+    }
+    return m;
+}
+
+
+/*
+    Fractal scene (Shaders/scene2)
+*/
+
+//Columns of the shader's mat3 ma
+static const vec3f FRACTAL_MA[3] = { vec3f( 0.60f, 0.00f,  0.80f),
+                                     vec3f( 0.00f, 1.00f,  0.00f),
+                                     vec3f(-0.80f, 0.00f,  0.60f) };
+
+template<typename T>
+static void shearX(hg::vec3<T>& p, T factor)
+{
+    p.y += factor * p.x;
+    p.z += factor * p.x;
+}
+
+template<typename T>
+static void shearZ(hg::vec3<T>& p, T factor)
+{
+    p.x += factor * p.z;
+    p.y += factor * p.z;
+}
+
+template<typename T>
+static T sponge(hg::vec3<T> p, float cubeSize)
+{
+    T d = fBoxCheap(p, vec3f(cubeSize));
+
+    float ani = glm::smoothstep(-0.2f, 0.2f, -std::cos(0.5f));
+    float off = 1.5f * std::sin(0.01f);
+
+    float s = 1.0f / cubeSize;
+    for (int m = 0; m < 5; m++)
+    {
+        hg::vec3<T> po = p + off;
+        hg::vec3<T> rotated = hg::vec3<T>(FRACTAL_MA[0]) * po.x + hg::vec3<T>(FRACTAL_MA[1]) * po.y + hg::vec3<T>(FRACTAL_MA[2]) * po.z;
+        p = p * (1.0f - ani) + rotated * ani;
+
+        hg::vec3<T> a = mod(p * s, hg::vec3<T>(T(2.0f))) - 1.0f;
+        s *= 3.0f;
+        hg::vec3<T> r = abs(hg::vec3<T>(T(1.0f)) - abs(a) * 3.0f);
+        T da = max(r.x, r.y);
+        T db = max(r.y, r.z);
+        T dc = max(r.z, r.x);
+        T c = (min(da, min(db, dc)) - T(1.0f)) / T(s);
+
+        d = select(c > d, c, d);
+    }
+    return d;
+}
+
+template<typename T>
+static T mod289(T x)
+{
+    return x - floor(x * T(1.0f / 289.0f)) * T(289.0f);
+}
+
+template<typename T>
+static T perm(T x)
+{
+    return mod289((x * T(34.0f) + T(1.0f)) * x);
+}
+
+//The vec4s of the shader are split into their components
+template<typename T>
+static T noise(const hg::vec3<T>& p)
+{
+    hg::vec3<T> a = floor(p);
+    hg::vec3<T> d = p - a;
+    d = d * d * (hg::vec3<T>(T(3.0f)) - d * 2.0f);
+
+    T b[4] = { a.x, a.x + T(1.0f), a.y, a.y + T(1.0f) };
+    T k1x = perm(b[0]);
+    T k1y = perm(b[1]);
+    T k2[4] = { perm(k1x + b[2]), perm(k1y + b[2]), perm(k1x + b[3]), perm(k1y + b[3]) };
+
+    T o3[4];
+    for (int i = 0; i < 4; ++i)
+    {
+        T c = k2[i] + a.z;
+        T o1 = fract(perm(c) * T(1.0f / 41.0f));
+        T o2 = fract(perm(c + T(1.0f)) * T(1.0f / 41.0f));
+        o3[i] = o2 * d.z + o1 * (T(1.0f) - d.z);
+    }
+    T o4x = o3[1] * d.x + o3[0] * (T(1.0f) - d.x);
+    T o4y = o3[3] * d.x + o3[2] * (T(1.0f) - d.x);
+
+    return o4y * d.y + o4x * (T(1.0f) - d.y);
+}
+
+FractalScene::FractalScene()
+    :
+    CpuScene(1500.0f, glm::vec3(-50.0f, 100.0f, 150.0f), 0.03f, false)
+{
+}
+
+template<typename T>
+hg::vec2<T> FractalScene::sdf(hg::vec3<T> p) const
+{
+    T boxID = T(6.0f);
+    hg::vec3<T> pSponge = p;
+
+    T noiseVal = noise(p * 0.01f) * T(2.0f);
+    shearX(pSponge, noiseVal / T(11.0f));
+    shearZ(pSponge, noiseVal / T(13.0f));
+    boxID += floor((abs(pSponge.x) + T(30.0f)) / T(60.0f)) / T(1000.0f);
+
+    pMod1(pSponge.z, 30.0f);
+    pMod2(pSponge.x, pSponge.y, vec2f(60.0f));
+
+    //The shader unions this with an uninitialized vec2, the sponge is the only object
+    return hg::vec2<T>(sponge(pSponge, 15.0f), boxID);
+}
+
+glm::vec2 FractalScene::closestObject(const glm::vec3& p) const
+{
+    vec2f res = sdf(toHg(p));
+    return glm::vec2(res.x, res.y);
+}
+
+PacketVec2 FractalScene::closestObjectPacket(const PacketVec3& p) const
+{
+    return sdf(p);
+}
+
+glm::vec4 FractalScene::closestObjectGradient(const glm::vec3& p) const
+{
+    return gradientOf(sdf(gradientVariables(p)).x);
+}
+
+float FractalScene::closestObjectSecondDerivative(const glm::vec3& p, const glm::vec3& u, const glm::vec3& v) const
+{
+    return sdf(directionVariables(p, u, v)).x.e12;
+}
+
+glm::vec3 FractalScene::getMaterial(glm::vec3 p, float id, glm::vec3 normal) const
+{
+    glm::vec3 m;
+    if (commonMaterial(p, (int)id, m))
+        return m;
+
+    switch ((int)id)
+    {
+        case 3:
+            m = glm::vec3(0.7f, 0.8f, 0.9f);
+            break;
+        case 5:
+            m = triplanar(texture(0), p, normal);
+            break;
+        case 6:
+        {
+            float seed = p.z / 97.0f;
+            float xModifier = fract(id) * 2000.0f;
+            m = glm::vec3(glm::clamp(std::sin(seed + xModifier + 23.038f), 0.1f, 0.9f),
+                          glm::clamp(std::sin(seed + xModifier + 14.660f), 0.1f, 0.9f),
+                          glm::clamp(std::sin(seed + xModifier), 0.1f, 0.9f));
+            break;
+        }
+        default:
+            m = glm::vec3(0.4f);
+            break;
+    }
+    return m;
+}
+
+
+/*
+    Terrain scene (Shaders/scene3)
+*/
+
+template<typename T>
+static T rand(const hg::vec2<T>& n)
+{
+    return fract(sin(n.x * T(12.9898f) + n.y * T(4.1414f) + T(1.1f)) * T(43758.5453f));
+}
+
+template<typename T>
+static T noise2D(const hg::vec2<T>& p)
+{
+    hg::vec2<T> ip = floor(p);
+    hg::vec2<T> u = p - ip;
+    u = u * u * (hg::vec2<T>(T(3.0f)) - u * 2.0f);
+
+    T res = mix(
+        mix(rand(ip), rand(ip + hg::vec2<T>(T(1.0f), T(0.0f))), u.x),
+        mix(rand(ip + hg::vec2<T>(T(0.0f), T(1.0f))), rand(ip + hg::vec2<T>(T(1.0f), T(1.0f))), u.x), u.y);
+    return res * res;
+}
+
+template<typename T>
+static T pyramid(hg::vec3<T> position, float halfRadius)
+{
+    position.x = abs(position.x);
+    position.z = abs(position.z);
+
+    // bottom
+    T s1 = abs(position.y) - T(halfRadius);
+    hg::vec3<T> base = hg::vec3<T>(max(position.x - T(halfRadius), T(0.0f)), abs(position.y + T(halfRadius)), max(position.z - T(halfRadius), T(0.0f)));
+    T d1 = dot(base, base);
+
+    hg::vec3<T> q = position - hg::vec3<T>(vec3f(halfRadius, -halfRadius, halfRadius));
+    const glm::vec3 end = glm::vec3(-halfRadius, 2.0f * halfRadius, -halfRadius);
+    hg::vec3<T> endT = hg::vec3<T>(toHg(end));
+    hg::vec3<T> segment = q - endT * clamp(dot(q, endT) / T(glm::dot(end, end)), 0.0f, 1.0f);
+    T d = dot(segment, segment);
+
+    // side
+    const glm::vec3 normal1 = glm::vec3(end.y, -end.x, 0.0f);
+    T s2 = q.x * T(normal1.x) + q.y * T(normal1.y);
+    T d2 = select((-(q.x * T(end.x) + q.y * T(end.y)) < T(0.0f)) & (dot(q, hg::vec3<T>(toHg(glm::cross(normal1, end)))) < T(0.0f)),
+                  s2 * s2 / T(normal1.x * normal1.x + normal1.y * normal1.y), d);
+    // front/back
+    const glm::vec3 normal2 = glm::vec3(0.0f, -end.z, end.y);
+    T s3 = q.y * T(normal2.y) + q.z * T(normal2.z);
+    T d3 = select((-(q.y * T(end.y) + q.z * T(end.z)) < T(0.0f)) & (dot(q, hg::vec3<T>(toHg(glm::cross(normal2, -end)))) < T(0.0f)),
+                  s3 * s3 / T(normal2.y * normal2.y + normal2.z * normal2.z), d);
+    return sqrt(min(min(d1, d2), d3)) * signum(max(max(s1, s2), s3));
+}
+
+template<typename T>
+static T terrain(const hg::vec3<T>& pos, T& terrainHeight, hg::mask_t<T>& isVolcanic)
+{
+    hg::vec2<T> xz = hg::vec2<T>(pos.x, pos.z);
+    T height = (
+        noise2D(xz * 0.002f) * T(5.0f)
+        + noise2D(xz * 0.02f) * T(0.5f)
+        + noise2D(xz * 0.1f) * T(0.15f)
+        - noise2D(xz * 0.001f) * T(2.0f)
+    ) * T(39.0f);
+
+    T volcanicAltitude = height - T(110.0f);
+    isVolcanic = volcanicAltitude > T(0.0f);
+    height = select(isVolcanic, height - volcanicAltitude * T(2.0f), height);
+
+    terrainHeight = height;
+    return pos.y - height;
+}
+
+template<typename T>
+static T tree(hg::vec3<T> ps, float r)
+{
+    T pyramidDist = pyramid(ps, r);
+    ps *= 1.2f;
+    ps.y -= T(2.0f);
+    pyramidDist = min(pyramid(ps, r), pyramidDist);
+    ps *= 1.2f;
+    ps.y -= T(2.0f);
+    pyramidDist = min(pyramid(ps, r), pyramidDist);
+    return pyramidDist;
+}
+
+TerrainScene::TerrainScene(const std::vector<const char*>& texturePaths)
+    :
+    CpuScene(15000.0f, glm::vec3(-5000.0f, 10000.0f, 15000.0f), 0.3f, false)
+{
+    loadTextures(texturePaths);
+}
+
+template<typename T>
+T TerrainScene::fbm(hg::vec2<T> p) const
+{
+    int numOctaves = 2;
+    float lacunarity = 1.0f;
+    float weight = 1.0f;
+    T ret = T(0.0f);
+    float frequency = 0.2f;
+    for (int i = 0; i < numOctaves; i++)
+    {
+        ret += T(weight) * sampleRed(texture(0), p * frequency);
+        p *= 2.0f;
+        weight *= 0.5f;
+        frequency *= lacunarity;
+    }
+    return clamp(ret, 0.0f, 1.0f);
+}
+
+template<typename T>
+hg::vec2<T> TerrainScene::sdf(hg::vec3<T> p) const
+{
+    float terrainID = 6.0f;
+    float planeID = 3.0f;
+    float treeID = 7.0f;
+    float lavaID = 9.0f;
+
+    T terrainHeight;
+    hg::mask_t<T> isVolcanic;
+    T terrainDistance = terrain(p, terrainHeight, isVolcanic);
+    T wave = fbm(hg::vec2<T>(p.x, p.z) + hg::vec2<T>(T(time)));
+    T seaDistance = fPlane(p, vec3f(0.0f, 1.0f, 0.0f), wave / T(15.0f));
+
+    hg::vec3<T> ps = p;
+    hg::vec3<T> ps2 = p;
+
+    float r = 2.0f;
+    ps.y -= terrainHeight + T(r);
+    pMod2(ps.x, ps.z, vec2f(6.0f));
+    T treeDist = tree(ps, r);
+
+    hg::vec2<T> res = fOpUnionID(hg::vec2<T>(terrainDistance, T(terrainID)), hg::vec2<T>(seaDistance, T(planeID)));
+    res = select((terrainHeight > T(10.0f)) & (terrainHeight < T(30.0f)), fOpUnionID(res, hg::vec2<T>(treeDist, T(treeID))), res);
+
+    ps2.y -= T(107.0f);
+    T lavaDistance = fPlane(ps2, vec3f(0.0f, 1.0f, 0.0f), wave / T(16.0f));
+    res = select(isVolcanic, fOpUnionID(res, hg::vec2<T>(lavaDistance, T(lavaID))), res);
+
+    return res;
+}
+
+glm::vec2 TerrainScene::closestObject(const glm::vec3& p) const
+{
+    vec2f res = sdf(toHg(p));
+    return glm::vec2(res.x, res.y);
+}
+
+PacketVec2 TerrainScene::closestObjectPacket(const PacketVec3& p) const
+{
+    return sdf(p);
+}
+
+glm::vec4 TerrainScene::closestObjectGradient(const glm::vec3& p) const
+{
+    return gradientOf(sdf(gradientVariables(p)).x);
+}
+
+float TerrainScene::closestObjectSecondDerivative(const glm::vec3& p, const glm::vec3& u, const glm::vec3& v) const
+{
+    return sdf(directionVariables(p, u, v)).x.e12;
+}
+
+glm::vec3 TerrainScene::getMaterial(glm::vec3 p, float id, glm::vec3 normal) const
+{
+    glm::vec3 m;
+    if (commonMaterial(p, (int)id, m))
+        return m;
+
+    switch ((int)id)
+    {
+        case 3:
+            m = glm::vec3(0.18f, 0.59f, 0.98f);
+            break;
+        case 5:
+            m = triplanar(texture(0), p, normal);
+            break;
+        case 6:
+        {
+            const glm::vec3 sand = glm::vec3(1.0f, 0.5f, 0.2f);
+            const glm::vec3 grass = glm::vec3(0.1f, 0.26f, 0.14f);
+            const glm::vec3 rock = glm::vec3(0.5f, 0.23f, 0.1f);
+            const glm::vec3 ash = glm::vec3(0.02f, 0.01f, 0.0f);
+            //Rock and Snow
+            m = glm::mix(rock, ash, glm::smoothstep(80.0f * ((3.0f + noise2D(vec2f(p.x, p.z))) / 4.0f), 90.0f, p.y));
+            //Forest
+            m = glm::mix(grass, m, glm::smoothstep(10.0f, 60.0f, p.y));
+            //Sand
+            m = glm::mix(sand, m, glm::smoothstep(0.0f, 10.0f, p.y));
+            break;
+        }
+        case 7:
+            m = glm::vec3(0.1f, 0.36f, 0.14f);
+            break;
+        case 8:
+        {
+            float izo = (fract(0.5f * p.y) <= 0.1f) ? 1.0f : 0.0f;
+            m = glm::mix(glm::vec3(0.8f), glm::vec3(0.37f, 0.12f, 0.0f), izo);
+            break;
+        }
+        case 9:
+            m = glm::vec3(0.78f, 0.18f, 0.09f);
+            break;
+        default:
+            m = glm::vec3(0.4f);
+            break;
+    }
+    return m;
+}
+
+
+std::unique_ptr<CpuScene> createCpuScene(const std::string& name, const std::vector<const char*>& texturePaths)
+{
+    if (name == "building")
+        return std::unique_ptr<CpuScene>(new BuildingScene(texturePaths));
+    if (name == "fractal")
+        return std::unique_ptr<CpuScene>(new FractalScene());
+    if (name == "terrain")
+        return std::unique_ptr<CpuScene>(new TerrainScene(texturePaths));
+    return nullptr;
+}
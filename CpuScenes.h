@@ -0,0 +1,129 @@
+#pragma once
+#ifndef CPU_SCENES_H
+#define CPU_SCENES_H
+
+#include <glm/glm.hpp>
+
+#include <vector>
+#include <string>
+#include <memory>
+
+#include "CpuTexture.h"
+#include "RayPacket.h"
+
+
+/*
+    C++ versions of the scene fragment shaders for the CPU renderer.
+ 
+    Each scene mirrors closest_object and get_material of its shader together with the
+    constants the shared marching/lighting code depends on. Objects are conveyed the same way
+    as in the shaders: vec2(sdf value, material ID).
+    closest_object is written once as a template over the scalar types of hg_sdf.h and
+    instantiated for single points, ray packets and the dual numbers of Dual.h.
+*/
+class CpuScene
+{
+public:
+    virtual ~CpuScene() {}
+
+    //Same as the "time" uniform of the shaders
+    void setTime(float time_in);
+    //Same as the "relaxation" uniform, over-relaxation factor of the primary march
+    void setRelaxation(float relaxation_in);
+
+    virtual glm::vec2 closestObject(const glm::vec3& p) const = 0;
+    //closestObject for PACKET_SIZE points at once. The default evaluates the lanes one by one.
+    virtual PacketVec2 closestObjectPacket(const PacketVec3& p) const;
+    /*
+        Distance at p (w) with its gradient (xyz). The scenes evaluate their sdf once with dual numbers,
+        which gives the exact gradient. The default takes central differences of closestObject.
+    */
+    virtual glm::vec4 closestObjectGradient(const glm::vec3& p) const;
+    /*
+        Second derivative of the distance at p along the directions u and v (u^T H v, the curvature along u
+        for v = u). The scenes evaluate their sdf once with hyper-dual numbers, the default takes differences.
+    */
+    virtual float closestObjectSecondDerivative(const glm::vec3& p, const glm::vec3& u, const glm::vec3& v) const;
+    virtual glm::vec3 getMaterial(glm::vec3 p, float id, glm::vec3 normal) const = 0;
+
+    //Getters
+    float getMaxDistance() const;
+    glm::vec3 getLightPosition() const;
+    float getShadowLightSize() const;
+    bool hasFog() const;
+    float getRelaxation() const;
+
+protected:
+    CpuScene(float maxDistance_in, glm::vec3 lightPosition_in, float shadowLightSize_in, bool fog_in);
+    void loadTextures(const std::vector<const char*>& texturePaths);
+    const CpuTexture& texture(int index) const;
+
+protected:
+    float time;
+    float relaxation;
+    //texture + index, in the same order as Scene::loadTextures
+    std::vector<CpuTexture> textures;
+
+private:
+    float maxDistance;
+    glm::vec3 lightPosition;
+    float shadowLightSize;
+    bool fog;
+};
+
+//Shaders/scene1
+class BuildingScene : public CpuScene
+{
+public:
+    BuildingScene(const std::vector<const char*>& texturePaths);
+    glm::vec2 closestObject(const glm::vec3& p) const override;
+    PacketVec2 closestObjectPacket(const PacketVec3& p) const override;
+    glm::vec4 closestObjectGradient(const glm::vec3& p) const override;
+    float closestObjectSecondDerivative(const glm::vec3& p, const glm::vec3& u, const glm::vec3& v) const override;
+    glm::vec3 getMaterial(glm::vec3 p, float id, glm::vec3 normal) const override;
+
+private:
+    //closest_object of the shader for float, PacketFloat, Dual and HyperDual
+    template<typename T> hg::vec2<T> sdf(hg::vec3<T> p) const;
+    template<typename T> hg::vec2<T> getPedestal(hg::vec3<T> p) const;
+    template<typename T> void translateSphere(hg::vec3<T>& p) const;
+    template<typename T> void rotateSphere(hg::vec3<T>& p) const;
+};
+
+//Shaders/scene2
+class FractalScene : public CpuScene
+{
+public:
+    FractalScene();
+    glm::vec2 closestObject(const glm::vec3& p) const override;
+    PacketVec2 closestObjectPacket(const PacketVec3& p) const override;
+    glm::vec4 closestObjectGradient(const glm::vec3& p) const override;
+    float closestObjectSecondDerivative(const glm::vec3& p, const glm::vec3& u, const glm::vec3& v) const override;
+    glm::vec3 getMaterial(glm::vec3 p, float id, glm::vec3 normal) const override;
+
+private:
+    //closest_object of the shader for float, PacketFloat, Dual and HyperDual
+    template<typename T> hg::vec2<T> sdf(hg::vec3<T> p) const;
+};
+
+//Shaders/scene3
+class TerrainScene : public CpuScene
+{
+public:
+    TerrainScene(const std::vector<const char*>& texturePaths);
+    glm::vec2 closestObject(const glm::vec3& p) const override;
+    PacketVec2 closestObjectPacket(const PacketVec3& p) const override;
+    glm::vec4 closestObjectGradient(const glm::vec3& p) const override;
+    float closestObjectSecondDerivative(const glm::vec3& p, const glm::vec3& u, const glm::vec3& v) const override;
+    glm::vec3 getMaterial(glm::vec3 p, float id, glm::vec3 normal) const override;
+
+private:
+    //closest_object of the shader for float, PacketFloat, Dual and HyperDual
+    template<typename T> hg::vec2<T> sdf(hg::vec3<T> p) const;
+    template<typename T> T fbm(hg::vec2<T> p) const;
+};
+
+//Returns nullptr for scenes without a CPU version
+std::unique_ptr<CpuScene> createCpuScene(const std::string& name, const std::vector<const char*>& texturePaths);
+
+#endif
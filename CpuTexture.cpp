@@ -0,0 +1,105 @@
+#include "CpuTexture.h"
+
+#include <cmath>
+
+#include "stb_image.h"
+
+CpuTexture::CpuTexture()
+    :
+    width(0),
+    height(0)
+{
+}
+
+bool CpuTexture::load(const char* filePath)
+{
+    stbi_set_flip_vertically_on_load(false);
+    int nrComponents;
+    unsigned char* data = stbi_load(filePath, &width, &height, &nrComponents, 0);
+    if (data == nullptr)
+    {
+        std::cout << "Texture failed to load on path: " << filePath << std::endl;
+        width = height = 0;
+        return false;
+    }
+
+    //Store normalized colors, single channel images are red only like GL_RED textures
+    texels.resize((size_t)width * height);
+    for (size_t i = 0; i < texels.size(); ++i)
+    {
+        const unsigned char* c = data + i * nrComponents;
+        texels[i] = glm::vec3(c[0],
+                              nrComponents > 2 ? c[1] : 0,
+                              nrComponents > 2 ? c[2] : 0) / 255.0f;
+    }
+
+    stbi_image_free(data);
+    return true;
+}
+
+glm::vec3 CpuTexture::sample(glm::vec2 uv) const
+{
+    if (texels.empty())
+        return glm::vec3(0.0f);
+
+    //Wrap first so large coordinates do not lose precision, texel centers are at half integer coordinates
+    uv -= glm::floor(uv);
+    float x = uv.x * width - 0.5f;
+    float y = uv.y * height - 0.5f;
+    float x0 = std::floor(x);
+    float y0 = std::floor(y);
+    float fx = x - x0;
+    float fy = y - y0;
+    int ix = (int)x0;
+    int iy = (int)y0;
+
+    glm::vec3 bottom = glm::mix(texel(ix, iy), texel(ix + 1, iy), fx);
+    glm::vec3 top = glm::mix(texel(ix, iy + 1), texel(ix + 1, iy + 1), fx);
+    return glm::mix(bottom, top, fy);
+}
+
+glm::vec3 CpuTexture::sample(glm::vec2 uv, glm::vec3& du, glm::vec3& dv, glm::vec3& duv) const
+{
+    if (texels.empty())
+    {
+        du = dv = duv = glm::vec3(0.0f);
+        return glm::vec3(0.0f);
+    }
+
+    uv -= glm::floor(uv);
+    float x = uv.x * width - 0.5f;
+    float y = uv.y * height - 0.5f;
+    float x0 = std::floor(x);
+    float y0 = std::floor(y);
+    float fx = x - x0;
+    float fy = y - y0;
+    int ix = (int)x0;
+    int iy = (int)y0;
+
+    //The filter is bilinear within a texel, its derivatives are the slopes between the four texels
+    glm::vec3 t00 = texel(ix, iy);
+    glm::vec3 t10 = texel(ix + 1, iy);
+    glm::vec3 t01 = texel(ix, iy + 1);
+    glm::vec3 t11 = texel(ix + 1, iy + 1);
+    glm::vec3 bottom = glm::mix(t00, t10, fx);
+    glm::vec3 top = glm::mix(t01, t11, fx);
+    du = glm::mix(t10 - t00, t11 - t01, fy) * (float)width;
+    dv = (top - bottom) * (float)height;
+    duv = (t11 - t01 - t10 + t00) * (float)(width * height);
+    return glm::mix(bottom, top, fy);
+}
+
+bool CpuTexture::isLoaded() const
+{
+    return !texels.empty();
+}
+
+glm::vec3 CpuTexture::texel(int x, int y) const
+{
+    //GL_REPEAT
+    x %= width;
+    y %= height;
+    if (x < 0) x += width;
+    if (y < 0) y += height;
+    return texels[(size_t)y * width + x];
+}
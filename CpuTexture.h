@@ -0,0 +1,37 @@
+#pragma once
+#ifndef CPU_TEXTURE_H
+#define CPU_TEXTURE_H
+
+#include <glm/glm.hpp>
+
+#include <vector>
+#include <iostream>
+
+
+/*
+    Texture sampled on the CPU the way the scenes sample their GL textures:
+    bilinear filtering and GL_REPEAT wrapping. Mipmaps are not generated.
+    A texture that failed to load samples as black, like an incomplete GL texture.
+*/
+class CpuTexture
+{
+public:
+    CpuTexture();
+    //Loads the image with stb_image, rows are not flipped (same as textureFromFile in main.cpp)
+    bool load(const char* filePath);
+
+    glm::vec3 sample(glm::vec2 uv) const;
+    //sample() with the derivatives of the filtered color along u and v and the mixed one, for automatic differentiation
+    glm::vec3 sample(glm::vec2 uv, glm::vec3& du, glm::vec3& dv, glm::vec3& duv) const;
+    bool isLoaded() const;
+
+private:
+    glm::vec3 texel(int x, int y) const;
+
+private:
+    std::vector<glm::vec3> texels;
+    int width;
+    int height;
+};
+
+#endif
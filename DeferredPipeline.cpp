@@ -0,0 +1,238 @@
+#include "DeferredPipeline.h"
+#include "FrameConstants.h"
+
+void DeferredPipeline::Programs::build(const char* vertexPath, const char* fragmentPath)
+{
+    for (int stage = 0; stage < STAGE_COUNT; ++stage)
+    {
+        Shader& shader = stages[stage];
+        shader = Shader(vertexPath, fragmentPath, nullptr, { stageDefine((Stage)stage) });
+        shader.bindUniformBlock(FrameConstantsBuffer::BLOCK_NAME, FrameConstantsBuffer::BINDING);
+        shader.use();
+        shader.uniform<int>("gbuffer_texture").set(GBUFFER_UNIT);
+        shader.uniform<int>("shadow_texture").set(SHADOW_UNIT);
+        shader.uniform<int>("ao_texture").set(AO_UNIT);
+        shader.uniform<int>("history_texture").set(HISTORY_UNIT);
+        lightingScale[stage] = shader.uniform<int>("lighting_scale");
+        lodBias[stage] = shader.uniform<float>("lod_bias");
+    }
+    relaxation = stages[GBUFFER].uniform<float>("relaxation");
+    normalEstimator = stages[GBUFFER].uniform<int>("normal_estimator");
+    heightfieldMarch = stages[GBUFFER].uniform<int>("heightfield_march");
+    temporalHistory = stages[GBUFFER].uniform<int>("temporal_history");
+    conePrepass.resolve(stages[GBUFFER]);
+    heightmap.resolve(stages[GBUFFER]);
+}
+
+bool DeferredPipeline::Programs::isValid() const
+{
+    for (const Shader& shader : stages)
+    {
+        if (!shader.isValid())
+            return false;
+    }
+    return true;
+}
+
+void DeferredPipeline::Programs::setRelaxation(float omega) const
+{
+    stages[GBUFFER].use();
+    relaxation.set(omega);
+}
+
+void DeferredPipeline::Programs::setNormalEstimator(int estimator) const
+{
+    stages[GBUFFER].use();
+    normalEstimator.set(estimator);
+}
+
+void DeferredPipeline::Programs::setHeightfieldMarch(bool enabled) const
+{
+    stages[GBUFFER].use();
+    heightfieldMarch.set(enabled ? 1 : 0);
+}
+
+void DeferredPipeline::Programs::setLodBias(float bias) const
+{
+    for (int stage = 0; stage < STAGE_COUNT; ++stage)
+    {
+        stages[stage].use();
+        lodBias[stage].set(bias);
+    }
+}
+
+void DeferredPipeline::Programs::setTextureUnit(const std::string& sampler, int unit) const
+{
+    for (const Shader& shader : stages)
+    {
+        shader.use();
+        shader.uniform<int>(sampler).set(unit);
+    }
+}
+
+DeferredPipeline::DeferredPipeline()
+    :
+    current(0),
+    historyPrograms(nullptr),
+    temporalCache(true),
+    width(0),
+    height(0),
+    lightingScale(1)
+{
+}
+
+void DeferredPipeline::create(int width_in, int height_in)
+{
+    release();
+    width = width_in;
+    height = height_in;
+    for (Framebuffer& gbuffer : gbuffers)
+        gbuffer = Framebuffer(width, height, {GL_RGBA32F}, false);
+    resetHistory();
+    allocateLighting();
+}
+
+void DeferredPipeline::resize(int width_in, int height_in)
+{
+    if (width_in == width && height_in == height)
+        return;
+    create(width_in, height_in);
+}
+
+void DeferredPipeline::setLightingScale(int scale)
+{
+    if (scale == lightingScale)
+        return;
+    lightingScale = scale;
+    if (width == 0)
+        return;
+    shadow.release();
+    ambientOcclusion.release();
+    allocateLighting();
+}
+
+int DeferredPipeline::getLightingScale() const
+{
+    return lightingScale;
+}
+
+void DeferredPipeline::setTemporalCache(bool enabled)
+{
+    temporalCache = enabled;
+}
+
+bool DeferredPipeline::isTemporalCacheEnabled() const
+{
+    return temporalCache;
+}
+
+void DeferredPipeline::resetHistory()
+{
+    historyPrograms = nullptr;
+}
+
+void DeferredPipeline::renderLighting(const Programs& programs, GLuint quad, GpuProfiler& profiler)
+{
+    //Last frame's G-buffer becomes the history
+    current = 1 - current;
+    const Framebuffer& gbuffer = gbuffers[current];
+    bool history = temporalCache && historyPrograms == &programs;
+    glActiveTexture(GL_TEXTURE0 + HISTORY_UNIT);
+    glBindTexture(GL_TEXTURE_2D, gbuffers[1 - current].getColorTexture());
+    programs.stages[GBUFFER].use();
+    programs.temporalHistory.set(history ? 1 : 0);
+    {
+        GpuProfiler::Scope pass(profiler, stageName(GBUFFER));
+        gbuffer.bind();
+        draw(programs.stages[GBUFFER], quad);
+    }
+    historyPrograms = &programs;
+
+    glActiveTexture(GL_TEXTURE0 + GBUFFER_UNIT);
+    glBindTexture(GL_TEXTURE_2D, gbuffer.getColorTexture());
+    for (Stage stage : { SHADOW, AMBIENT_OCCLUSION, SHADE })
+    {
+        programs.stages[stage].use();
+        programs.lightingScale[stage].set(lightingScale);
+    }
+    {
+        GpuProfiler::Scope pass(profiler, stageName(SHADOW));
+        shadow.bind();
+        draw(programs.stages[SHADOW], quad);
+    }
+    {
+        GpuProfiler::Scope pass(profiler, stageName(AMBIENT_OCCLUSION));
+        ambientOcclusion.bind();
+        draw(programs.stages[AMBIENT_OCCLUSION], quad);
+    }
+
+    glActiveTexture(GL_TEXTURE0 + SHADOW_UNIT);
+    glBindTexture(GL_TEXTURE_2D, shadow.getColorTexture());
+    glActiveTexture(GL_TEXTURE0 + AO_UNIT);
+    glBindTexture(GL_TEXTURE_2D, ambientOcclusion.getColorTexture());
+}
+
+void DeferredPipeline::renderShading(const Programs& programs, GLuint quad, GpuProfiler& profiler) const
+{
+    GpuProfiler::Scope pass(profiler, stageName(SHADE));
+    draw(programs.stages[SHADE], quad);
+}
+
+void DeferredPipeline::release()
+{
+    for (Framebuffer& gbuffer : gbuffers)
+        gbuffer.release();
+    resetHistory();
+    shadow.release();
+    ambientOcclusion.release();
+}
+
+int DeferredPipeline::getWidth() const
+{
+    return width;
+}
+
+int DeferredPipeline::getHeight() const
+{
+    return height;
+}
+
+const char* DeferredPipeline::stageName(Stage stage)
+{
+    switch (stage)
+    {
+        case GBUFFER: return "gbuffer";
+        case SHADOW: return "shadow";
+        case AMBIENT_OCCLUSION: return "ao";
+        case SHADE: return "shade";
+        default: return "";
+    }
+}
+
+const char* DeferredPipeline::stageDefine(Stage stage)
+{
+    switch (stage)
+    {
+        case GBUFFER: return "DEFERRED_GBUFFER";
+        case SHADOW: return "DEFERRED_SHADOW";
+        case AMBIENT_OCCLUSION: return "DEFERRED_AO";
+        case SHADE: return "DEFERRED_SHADE";
+        default: return "";
+    }
+}
+
+void DeferredPipeline::allocateLighting()
+{
+    //Partial blocks at the right and top border get a texel too
+    int lightingWidth = (width + lightingScale - 1) / lightingScale;
+    int lightingHeight = (height + lightingScale - 1) / lightingScale;
+    shadow = Framebuffer(lightingWidth, lightingHeight, {GL_R16F}, false);
+    ambientOcclusion = Framebuffer(lightingWidth, lightingHeight, {GL_R16F}, false);
+}
+
+void DeferredPipeline::draw(const Shader& shader, GLuint quad)
+{
+    shader.use();
+    glBindVertexArray(quad);
+    glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0);
+}
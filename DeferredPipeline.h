@@ -0,0 +1,132 @@
+#pragma once
+#ifndef DEFERRED_PIPELINE_H
+#define DEFERRED_PIPELINE_H
+
+#include <GL/glew.h>
+
+#include <string>
+
+#include "Shader.h"
+#include "Framebuffer.h"
+#include "ConePrepass.h"
+#include "Heightmap.h"
+#include "GpuProfiler.h"
+
+
+/*
+    Deferred version of the scene shaders (Shaders/deferred.glsl).
+
+    The single pass shader marches, estimates the normal, traces the soft shadow and the ambient
+    occlusion and shades in one fragment invocation, so neighbouring pixels diverge wherever one of
+    them needs a long shadow ray and the other hits the sky. Here every part is its own program and pass:
+
+    - GBUFFER: primary march and normal -> RGBA32F (distance, material ID, octahedral normal)
+    - SHADOW: soft shadow ray from the G-buffer hit -> R16F
+    - AMBIENT_OCCLUSION: occlusion taps from the G-buffer hit -> R16F
+    - SHADE: material and light from the three textures -> the caller's render target
+
+    Shadow and AO can be traced at 1/2 or 1/4 of the resolution per axis (setLightingScale): each texel
+    traces from one G-buffer sample of its block and the shading pass upsamples them with a depth and
+    normal aware bilateral filter, which keeps the terms from bleeding across silhouettes.
+
+    The G-buffer alternates between two targets so last frame's one stays readable as the history of
+    the temporal cache (Shaders/temporal_cache.glsl): the G-buffer pass reprojects its hit distances
+    with the previous camera of the frame constants and starts the primary rays just in front of them.
+    The history is dropped when the targets are reallocated, another scene is rendered or resetHistory()
+    is called (camera cuts, frames rendered without the pipeline).
+
+    The programs of a scene are built from its fragment shader with one DEFERRED_* define per stage.
+    Like Framebuffer, it is a light handle around GL names. Call release() to free them.
+*/
+class DeferredPipeline
+{
+public:
+    enum Stage
+    {
+        GBUFFER,
+        SHADOW,
+        AMBIENT_OCCLUSION,
+        SHADE,
+        STAGE_COUNT
+    };
+
+    //Texture units of the intermediate results, above the cone prepass unit
+    static constexpr int GBUFFER_UNIT = ConePrepass::TEXTURE_UNIT + 1;
+    static constexpr int SHADOW_UNIT = ConePrepass::TEXTURE_UNIT + 2;
+    static constexpr int AO_UNIT = ConePrepass::TEXTURE_UNIT + 3;
+    static constexpr int HISTORY_UNIT = ConePrepass::TEXTURE_UNIT + 4;
+
+    //Programs of one scene
+    struct Programs
+    {
+        Shader stages[STAGE_COUNT];
+        //Uniforms of the G-buffer stage, the only one that marches primary rays
+        Uniform<float> relaxation;
+        Uniform<int> normalEstimator;
+        Uniform<int> heightfieldMarch;
+        ConePrepass::Uniforms conePrepass;
+        Heightmap::Uniforms heightmap;
+        Uniform<int> lightingScale[STAGE_COUNT];
+        //Every stage evaluates the distance function, at the same level of detail
+        Uniform<float> lodBias[STAGE_COUNT];
+        Uniform<int> temporalHistory;
+
+        //Builds every stage and binds the frame constants block
+        void build(const char* vertexPath, const char* fragmentPath);
+        bool isValid() const;
+        void setRelaxation(float omega) const;
+        void setNormalEstimator(int estimator) const;
+        void setHeightfieldMarch(bool enabled) const;
+        void setLodBias(float bias) const;
+        //Assigns a sampler of the scene textures in every stage
+        void setTextureUnit(const std::string& sampler, int unit) const;
+    };
+
+    DeferredPipeline();
+    //Allocates the targets for an image of the given size, needs a current context
+    void create(int width_in, int height_in);
+    void resize(int width_in, int height_in);
+    //Full resolution pixels per texel side of the shadow and AO targets: 1, 2 or 4
+    void setLightingScale(int scale);
+    int getLightingScale() const;
+    //Temporal reprojection of the primary hit distances, on by default
+    void setTemporalCache(bool enabled);
+    bool isTemporalCacheEnabled() const;
+    //The next frame marches without history
+    void resetHistory();
+    /*
+        G-buffer, shadow and ambient occlusion passes; the frame constants and scene textures have to be
+        bound (and the cone prepass rendered with the G-buffer program if it is used).
+        Leaves the results bound for renderShading, the caller binds its render target afterwards.
+    */
+    void renderLighting(const Programs& programs, GLuint quad, GpuProfiler& profiler);
+    //Shading pass into the bound render target
+    void renderShading(const Programs& programs, GLuint quad, GpuProfiler& profiler) const;
+    void release();
+
+    int getWidth() const;
+    int getHeight() const;
+
+    static const char* stageName(Stage stage);
+    //Define that selects the stage in the scene shaders
+    static const char* stageDefine(Stage stage);
+
+private:
+    static void draw(const Shader& shader, GLuint quad);
+    void allocateLighting();
+
+private:
+    //The current G-buffer and last frame's one
+    Framebuffer gbuffers[2];
+    int current;
+    //Programs that rendered the history, nullptr if there is none
+    const Programs* historyPrograms;
+    bool temporalCache;
+    Framebuffer shadow;
+    Framebuffer ambientOcclusion;
+    int width;
+    int height;
+    int lightingScale;
+};
+
+#endif
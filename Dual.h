@@ -0,0 +1,230 @@
+#pragma once
+#ifndef DUAL_H
+#define DUAL_H
+
+#include <cmath>
+#include <type_traits>
+
+#include "hg_sdf.h"
+
+/*
+    Forward mode automatic differentiation for the templated SDF code of hg_sdf.h and CpuScenes.
+
+    Dual carries a value and its gradient with respect to the three coordinates of the point the
+    distance function is evaluated at, so one evaluation returns the distance and its exact gradient.
+    HyperDual carries a value and its derivatives along two directions e1 and e2 together with the
+    mixed second derivative e1e2, which is exact as well (no step size, no cancellation):
+    f(p + e1 u + e2 v) = f(p) + e1 df/du + e2 df/dv + e1e2 d2f/dudv
+
+    Both provide the interface hg_sdf.h asks of scalar types: arithmetic operators, comparisons of
+    the values returning bool (so hg's any(bool) applies) and select, min, max, abs, floor, sqrt,
+    sin, cos, atan2 and pow, found by argument dependent lookup. They construct implicitly from
+    float, constants carry no derivatives. Branches only follow the values, the derivatives are the
+    ones of the branch taken, and floor (steps of fract, mod and the domain repetitions) has none.
+*/
+namespace ad
+{
+    struct Dual
+    {
+        float v;
+        hg::vec3<float> d;
+
+        Dual() : v(0.0f) {}
+        Dual(float v_in) : v(v_in) {}
+        Dual(float v_in, const hg::vec3<float>& d_in) : v(v_in), d(d_in) {}
+    };
+
+    struct HyperDual
+    {
+        float v;
+        float e1;
+        float e2;
+        float e12;
+
+        HyperDual() : v(0.0f), e1(0.0f), e2(0.0f), e12(0.0f) {}
+        HyperDual(float v_in) : v(v_in), e1(0.0f), e2(0.0f), e12(0.0f) {}
+        HyperDual(float v_in, float e1_in, float e2_in, float e12_in) : v(v_in), e1(e1_in), e2(e2_in), e12(e12_in) {}
+    };
+
+    template<typename D>
+    struct IsDual : std::false_type {};
+    template<>
+    struct IsDual<Dual> : std::true_type {};
+    template<>
+    struct IsDual<HyperDual> : std::true_type {};
+
+    template<typename D>
+    using EnableIfDual = typename std::enable_if<IsDual<D>::value, int>::type;
+
+    /*
+        Arithmetic, not templated so floats on either side convert implicitly
+    */
+
+    inline Dual operator+(const Dual& a, const Dual& b) { return Dual(a.v + b.v, a.d + b.d); }
+    inline Dual operator-(const Dual& a, const Dual& b) { return Dual(a.v - b.v, a.d - b.d); }
+    inline Dual operator*(const Dual& a, const Dual& b) { return Dual(a.v * b.v, a.d * b.v + b.d * a.v); }
+    inline Dual operator/(const Dual& a, const Dual& b) { return Dual(a.v / b.v, (a.d * b.v - b.d * a.v) / (b.v * b.v)); }
+    inline Dual operator-(const Dual& a) { return Dual(-a.v, -a.d); }
+
+    inline HyperDual operator+(const HyperDual& a, const HyperDual& b) { return HyperDual(a.v + b.v, a.e1 + b.e1, a.e2 + b.e2, a.e12 + b.e12); }
+    inline HyperDual operator-(const HyperDual& a, const HyperDual& b) { return HyperDual(a.v - b.v, a.e1 - b.e1, a.e2 - b.e2, a.e12 - b.e12); }
+    inline HyperDual operator*(const HyperDual& a, const HyperDual& b)
+    {
+        return HyperDual(a.v * b.v, a.e1 * b.v + a.v * b.e1, a.e2 * b.v + a.v * b.e2,
+                         a.e12 * b.v + a.e1 * b.e2 + a.e2 * b.e1 + a.v * b.e12);
+    }
+    inline HyperDual operator-(const HyperDual& a) { return HyperDual(-a.v, -a.e1, -a.e2, -a.e12); }
+
+    /*
+        Function of one variable applied to x, f(x.v) with its first and second derivatives.
+        Dual only needs the first one.
+    */
+    inline Dual chain(const Dual& x, float f, float df, float)
+    {
+        return Dual(f, x.d * df);
+    }
+
+    inline HyperDual chain(const HyperDual& x, float f, float df, float d2f)
+    {
+        return HyperDual(f, df * x.e1, df * x.e2, df * x.e12 + d2f * x.e1 * x.e2);
+    }
+
+    inline HyperDual operator/(const HyperDual& a, const HyperDual& b)
+    {
+        float r = 1.0f / b.v;
+        return a * chain(b, r, -r * r, 2.0f * r * r * r);
+    }
+
+    /*
+        Function f(u, v) that is bilinear around the point (its pure second derivatives are 0),
+        given its value, first derivatives and mixed derivative there. Bilinear texture filtering.
+    */
+    inline Dual bilinear(float f, float fu, float fv, float, const Dual& u, const Dual& v)
+    {
+        return Dual(f, u.d * fu + v.d * fv);
+    }
+
+    inline HyperDual bilinear(float f, float fu, float fv, float fuv, const HyperDual& u, const HyperDual& v)
+    {
+        return HyperDual(f, fu * u.e1 + fv * v.e1, fu * u.e2 + fv * v.e2,
+                         fu * u.e12 + fv * v.e12 + fuv * (u.e1 * v.e2 + u.e2 * v.e1));
+    }
+
+    template<typename D, EnableIfDual<D> = 0> inline D& operator+=(D& a, const D& b) { return a = a + b; }
+    template<typename D, EnableIfDual<D> = 0> inline D& operator-=(D& a, const D& b) { return a = a - b; }
+    template<typename D, EnableIfDual<D> = 0> inline D& operator*=(D& a, const D& b) { return a = a * b; }
+    template<typename D, EnableIfDual<D> = 0> inline D& operator/=(D& a, const D& b) { return a = a / b; }
+
+    //Comparisons of the values
+    inline bool operator<(const Dual& a, const Dual& b) { return a.v < b.v; }
+    inline bool operator<=(const Dual& a, const Dual& b) { return a.v <= b.v; }
+    inline bool operator>(const Dual& a, const Dual& b) { return a.v > b.v; }
+    inline bool operator>=(const Dual& a, const Dual& b) { return a.v >= b.v; }
+    inline bool operator==(const Dual& a, const Dual& b) { return a.v == b.v; }
+
+    inline bool operator<(const HyperDual& a, const HyperDual& b) { return a.v < b.v; }
+    inline bool operator<=(const HyperDual& a, const HyperDual& b) { return a.v <= b.v; }
+    inline bool operator>(const HyperDual& a, const HyperDual& b) { return a.v > b.v; }
+    inline bool operator>=(const HyperDual& a, const HyperDual& b) { return a.v >= b.v; }
+    inline bool operator==(const HyperDual& a, const HyperDual& b) { return a.v == b.v; }
+
+    /*
+        Functions hg_sdf.h needs
+    */
+
+    template<typename D, EnableIfDual<D> = 0>
+    inline D select(bool condition, const D& a, const D& b)
+    {
+        return condition ? a : b;
+    }
+
+    template<typename D, EnableIfDual<D> = 0>
+    inline D min(const D& a, const D& b)
+    {
+        return (a < b) ? a : b;
+    }
+
+    template<typename D, EnableIfDual<D> = 0>
+    inline D max(const D& a, const D& b)
+    {
+        return (a > b) ? a : b;
+    }
+
+    template<typename D, EnableIfDual<D> = 0>
+    inline D abs(const D& x)
+    {
+        return (x.v < 0.0f) ? -x : x;
+    }
+
+    template<typename D, EnableIfDual<D> = 0>
+    inline D floor(const D& x)
+    {
+        return D(std::floor(x.v));
+    }
+
+    //The derivatives are taken as 0 at 0 (e.g. the length of a vector clamped to 0) instead of infinite
+    template<typename D, EnableIfDual<D> = 0>
+    inline D sqrt(const D& x)
+    {
+        float f = std::sqrt(x.v);
+        if (!(f > 0.0f))
+            return D(f);
+        return chain(x, f, 0.5f / f, -0.25f / (f * x.v));
+    }
+
+    template<typename D, EnableIfDual<D> = 0>
+    inline D sin(const D& x)
+    {
+        float s = std::sin(x.v);
+        return chain(x, s, std::cos(x.v), -s);
+    }
+
+    template<typename D, EnableIfDual<D> = 0>
+    inline D cos(const D& x)
+    {
+        float c = std::cos(x.v);
+        return chain(x, c, -std::sin(x.v), -c);
+    }
+
+    template<typename D, EnableIfDual<D> = 0>
+    inline D exp(const D& x)
+    {
+        float e = std::exp(x.v);
+        return chain(x, e, e, e);
+    }
+
+    template<typename D, EnableIfDual<D> = 0>
+    inline D log(const D& x)
+    {
+        float r = 1.0f / x.v;
+        return chain(x, std::log(x.v), r, -r * r);
+    }
+
+    //Differentiated as atan(y / x) or -atan(x / y), whichever divides by the larger component
+    template<typename D, EnableIfDual<D> = 0>
+    inline D atan2(const D& y, const D& x)
+    {
+        float angle = std::atan2(y.v, x.v);
+        bool overX = std::abs(x.v) >= std::abs(y.v);
+        D t = overX ? y / x : x / y;
+        float sign = overX ? 1.0f : -1.0f;
+        float q = 1.0f / (1.0f + t.v * t.v);
+        return chain(t, angle, sign * q, -2.0f * sign * t.v * q * q);
+    }
+
+    //Through exp and log where the base is positive, otherwise the exponent is taken as constant
+    template<typename D, EnableIfDual<D> = 0>
+    inline D pow(const D& x, const D& e)
+    {
+        if (x.v > 0.0f)
+        {
+            D p = exp(e * log(x));
+            p.v = std::pow(x.v, e.v);
+            return p;
+        }
+        float n = e.v;
+        return chain(x, std::pow(x.v, n), n * std::pow(x.v, n - 1.0f), n * (n - 1.0f) * std::pow(x.v, n - 2.0f));
+    }
+}
+
+#endif
@@ -0,0 +1,96 @@
+#include "DynamicResolution.h"
+
+#include <algorithm>
+#include <cmath>
+
+DynamicResolution::DynamicResolution()
+    :
+    outputWidth(0),
+    outputHeight(0),
+    budget(0.0),
+    scale(MAX_SCALE),
+    frameTime(0.0),
+    settleFrames(0)
+{
+}
+
+void DynamicResolution::create(int outputWidth_in, int outputHeight_in, double budgetMilliseconds)
+{
+    outputWidth = outputWidth_in;
+    outputHeight = outputHeight_in;
+    budget = budgetMilliseconds;
+    scale = MAX_SCALE;
+    frameTime = 0.0;
+    settleFrames = 0;
+    allocate();
+}
+
+bool DynamicResolution::update(double gpuMilliseconds)
+{
+    if (gpuMilliseconds <= 0.0)
+        return false;
+    if (settleFrames > 0)
+    {
+        --settleFrames;
+        return false;
+    }
+    frameTime = (frameTime > 0.0) ? frameTime + SMOOTHING * (gpuMilliseconds - frameTime) : gpuMilliseconds;
+
+    //Largest scale step whose predicted frame time is within the headroom
+    float ideal = scale * (float)std::sqrt(HEADROOM * budget / frameTime);
+    float next = std::floor(ideal / SCALE_STEP + 1e-3f) * SCALE_STEP;
+    next = std::min(std::max(next, MIN_SCALE), MAX_SCALE);
+    bool overBudget = (frameTime > budget && next < scale);
+    if (!overBudget && next <= scale)
+        return false;
+
+    frameTime *= (next * next) / (scale * scale);
+    scale = next;
+    settleFrames = SETTLE_FRAMES;
+    allocate();
+    return true;
+}
+
+void DynamicResolution::upscale(GpuProfiler& profiler) const
+{
+    GpuProfiler::Scope pass(profiler, "upscale");
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, target.getID());
+    glBindFramebuffer(GL_DRAW_FRAMEBUFFER, 0);
+    glBlitFramebuffer(0, 0, target.getWidth(), target.getHeight(), 0, 0, outputWidth, outputHeight, GL_COLOR_BUFFER_BIT, GL_LINEAR);
+    Framebuffer::bindDefault(outputWidth, outputHeight);
+}
+
+void DynamicResolution::release()
+{
+    target.release();
+}
+
+const Framebuffer& DynamicResolution::getRenderTarget() const
+{
+    return target;
+}
+
+int DynamicResolution::getRenderWidth() const
+{
+    return target.getWidth();
+}
+
+int DynamicResolution::getRenderHeight() const
+{
+    return target.getHeight();
+}
+
+float DynamicResolution::getScale() const
+{
+    return scale;
+}
+
+void DynamicResolution::allocate()
+{
+    int width = std::max((int)std::lround(outputWidth * scale), 1);
+    int height = std::max((int)std::lround(outputHeight * scale), 1);
+    if (target.getID() == 0)
+        target = Framebuffer(width, height, {GL_RGBA8}, false);
+    else
+        target.resize(width, height);
+}
@@ -0,0 +1,63 @@
+#pragma once
+#ifndef DYNAMIC_RESOLUTION_H
+#define DYNAMIC_RESOLUTION_H
+
+#include <GL/glew.h>
+
+#include "Framebuffer.h"
+#include "GpuProfiler.h"
+
+
+/*
+    Scales the resolution the scenes are marched at to hold a GPU frame time budget.
+
+    The scene renders into getRenderTarget() and upscale() stretches it over the window. update() takes
+    the GPU time of every measured frame: the frame cost grows with the pixel count, so the scale moves
+    by the square root of the ratio between the budget and the smoothed frame time. It aims at HEADROOM
+    of the budget and only grows while the result would still fit, so it settles instead of flipping
+    between two sizes. Scales are multiples of SCALE_STEP, which keeps the reallocations rare.
+
+    GpuProfiler results arrive a few frames late, the next SETTLE_FRAMES measurements after a change
+    are skipped so they are not mistaken for the new resolution.
+    Like Framebuffer, it is a light handle around GL names. Call release() to free them.
+*/
+class DynamicResolution
+{
+public:
+    static constexpr float MIN_SCALE = 0.5f;
+    static constexpr float MAX_SCALE = 1.0f;
+    static constexpr float SCALE_STEP = 0.05f;
+    static constexpr double HEADROOM = 0.85;
+    //Weight of a new measurement in the smoothed frame time
+    static constexpr double SMOOTHING = 0.2;
+    static constexpr int SETTLE_FRAMES = 8;
+
+    DynamicResolution();
+    //Starts at full resolution, needs a current context
+    void create(int outputWidth_in, int outputHeight_in, double budgetMilliseconds);
+    //Feeds the GPU time of one frame, returns true if the render target was resized
+    bool update(double gpuMilliseconds);
+    //Stretches the render target over the window with bilinear filtering
+    void upscale(GpuProfiler& profiler) const;
+    void release();
+
+    const Framebuffer& getRenderTarget() const;
+    int getRenderWidth() const;
+    int getRenderHeight() const;
+    float getScale() const;
+
+private:
+    void allocate();
+
+private:
+    Framebuffer target;
+    int outputWidth;
+    int outputHeight;
+    double budget;
+    float scale;
+    //Smoothed frame time, 0 until the first measurement
+    double frameTime;
+    int settleFrames;
+};
+
+#endif
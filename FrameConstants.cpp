@@ -0,0 +1,101 @@
+#include "FrameConstants.h"
+
+#include <cstring>
+
+FrameConstantsBuffer::FrameConstantsBuffer()
+    :
+    buffer(0),
+    stride(0),
+    mapped(nullptr),
+    fences(),
+    slot(0),
+    previous(),
+    hasPrevious(false)
+{
+}
+
+void FrameConstantsBuffer::create()
+{
+    GLint alignment = 256;
+    glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &alignment);
+    stride = ((GLsizeiptr)sizeof(FrameConstantsBlock) + alignment - 1) / alignment * alignment;
+    GLsizeiptr size = stride * RING_SIZE;
+
+    glGenBuffers(1, &buffer);
+    glBindBuffer(GL_UNIFORM_BUFFER, buffer);
+    if (GLEW_VERSION_4_4 || GLEW_ARB_buffer_storage)
+    {
+        GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+        glBufferStorage(GL_UNIFORM_BUFFER, size, NULL, flags);
+        mapped = (char*)glMapBufferRange(GL_UNIFORM_BUFFER, 0, size, flags);
+    }
+    if (mapped == nullptr)
+    {
+        glBufferData(GL_UNIFORM_BUFFER, size, NULL, GL_DYNAMIC_DRAW);
+    }
+    glBindBuffer(GL_UNIFORM_BUFFER, 0);
+}
+
+void FrameConstantsBuffer::update(const FrameConstantsBlock& constants)
+{
+    //The slot was last used RING_SIZE frames ago, this only blocks if the GPU is that far behind
+    if (fences[slot] != 0)
+    {
+        glClientWaitSync(fences[slot], GL_SYNC_FLUSH_COMMANDS_BIT, 1000000000ull);
+        glDeleteSync(fences[slot]);
+        fences[slot] = 0;
+    }
+
+    FrameConstantsBlock block = constants;
+    const FrameConstantsBlock& last = hasPrevious ? previous : constants;
+    block.previousCameraPos = last.cameraPos;
+    block.previousFront = last.front;
+    block.previousRight = last.right;
+    block.previousUp = last.up;
+    block.previousJitter = last.jitter;
+    previous = constants;
+    hasPrevious = true;
+
+    GLintptr offset = stride * slot;
+    if (mapped != nullptr)
+    {
+        std::memcpy(mapped + offset, &block, sizeof(block));
+    }
+    else
+    {
+        glBindBuffer(GL_UNIFORM_BUFFER, buffer);
+        glBufferSubData(GL_UNIFORM_BUFFER, offset, sizeof(block), &block);
+        glBindBuffer(GL_UNIFORM_BUFFER, 0);
+    }
+    glBindBufferRange(GL_UNIFORM_BUFFER, BINDING, buffer, offset, sizeof(block));
+}
+
+void FrameConstantsBuffer::endFrame()
+{
+    fences[slot] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    slot = (slot + 1) % RING_SIZE;
+}
+
+void FrameConstantsBuffer::release()
+{
+    for (GLsync& fence : fences)
+    {
+        if (fence != 0)
+            glDeleteSync(fence);
+        fence = 0;
+    }
+    if (mapped != nullptr)
+    {
+        glBindBuffer(GL_UNIFORM_BUFFER, buffer);
+        glUnmapBuffer(GL_UNIFORM_BUFFER);
+        glBindBuffer(GL_UNIFORM_BUFFER, 0);
+        mapped = nullptr;
+    }
+    glDeleteBuffers(1, &buffer);
+    buffer = 0;
+}
+
+bool FrameConstantsBuffer::isPersistent() const
+{
+    return mapped != nullptr;
+}
@@ -0,0 +1,85 @@
+#pragma once
+#ifndef FRAME_CONSTANTS_H
+#define FRAME_CONSTANTS_H
+
+#include <GL/glew.h>
+#include <glm/glm.hpp>
+
+#include <string>
+#include <iostream>
+
+
+/*
+    CPU mirror of the FrameConstants block in Shaders/frame_constants.glsl (std140).
+    A vec3 is aligned to 16 bytes, a following scalar fills its fourth component.
+*/
+struct FrameConstantsBlock
+{
+    glm::vec3 cameraPos;
+    float time;
+    glm::vec3 front;
+    float padding0;
+    glm::vec3 right;
+    float padding1;
+    glm::vec3 up;
+    float padding2;
+    glm::vec2 resolution;
+    //Subpixel offset of the primary rays in pixels, nonzero with temporal anti-aliasing
+    glm::vec2 jitter;
+    //Camera and jitter of the previous update, filled by FrameConstantsBuffer::update
+    glm::vec3 previousCameraPos;
+    float padding4;
+    glm::vec3 previousFront;
+    float padding5;
+    glm::vec3 previousRight;
+    float padding6;
+    glm::vec3 previousUp;
+    float padding7;
+    glm::vec2 previousJitter;
+    glm::vec2 padding8;
+};
+static_assert(sizeof(FrameConstantsBlock) == 160, "FrameConstantsBlock has to match the std140 layout");
+
+/*
+    Uniform buffer holding FrameConstantsBlock, shared by every program that includes
+    frame_constants.glsl (see Shader::bindUniformBlock).
+
+    The buffer is a ring of RING_SIZE slots so the CPU never writes a slot the GPU may still read.
+    Each frame fills one slot with a single memcpy, binds its range and fences it in endFrame().
+    With GL 4.4 / ARB_buffer_storage the buffer is mapped once, persistently and coherently,
+    otherwise the slot is updated with glBufferSubData.
+    Like Framebuffer, it is a light handle around GL names. Call release() to free them.
+*/
+class FrameConstantsBuffer
+{
+public:
+    static constexpr int RING_SIZE = 3;
+    static constexpr GLuint BINDING = 0;
+    static constexpr const char* BLOCK_NAME = "FrameConstants";
+
+    FrameConstantsBuffer();
+    //Needs a current context
+    void create();
+    /*
+        Writes the constants of the next frame and binds them to BINDING.
+        The previous camera and jitter fields are taken from the last update (the first one repeats its own camera).
+    */
+    void update(const FrameConstantsBlock& constants);
+    //Call after the draws of the frame are submitted
+    void endFrame();
+    void release();
+
+    bool isPersistent() const;
+
+private:
+    GLuint buffer;
+    //Distance between slots, rounded up to GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT
+    GLsizeiptr stride;
+    char* mapped;
+    GLsync fences[RING_SIZE];
+    int slot;
+    FrameConstantsBlock previous;
+    bool hasPrevious;
+};
+
+#endif
@@ -0,0 +1,164 @@
+#include "Framebuffer.h"
+
+//Maps a sized internal format to the pixel format and type glTexImage2D expects
+static void pixelTransferFormat(GLenum internalFormat, GLenum& format, GLenum& type)
+{
+    switch (internalFormat)
+    {
+        case GL_R8:
+            format = GL_RED; type = GL_UNSIGNED_BYTE; break;
+        case GL_R16F:
+        case GL_R32F:
+            format = GL_RED; type = GL_FLOAT; break;
+        case GL_RG16F:
+        case GL_RG32F:
+            format = GL_RG; type = GL_FLOAT; break;
+        case GL_RGBA16F:
+        case GL_RGBA32F:
+            format = GL_RGBA; type = GL_FLOAT; break;
+        default:
+            format = GL_RGBA; type = GL_UNSIGNED_BYTE; break;
+    }
+}
+
+Framebuffer::Framebuffer()
+    :
+    ID(0),
+    depthBuffer(0),
+    width(0),
+    height(0),
+    hasDepth(false)
+{
+}
+
+Framebuffer::Framebuffer(int width_in, int height_in, const std::vector<GLenum>& colorFormats_in, bool withDepth)
+    :
+    ID(0),
+    depthBuffer(0),
+    colorFormats(colorFormats_in),
+    width(width_in),
+    height(height_in),
+    hasDepth(withDepth)
+{
+    allocate();
+}
+
+void Framebuffer::bind() const
+{
+    glBindFramebuffer(GL_FRAMEBUFFER, ID);
+    glViewport(0, 0, width, height);
+}
+
+void Framebuffer::bindDefault(int width, int height)
+{
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    glViewport(0, 0, width, height);
+}
+
+void Framebuffer::resize(int width_in, int height_in)
+{
+    if (width_in == width && height_in == height)
+        return;
+
+    release();
+    width = width_in;
+    height = height_in;
+    allocate();
+}
+
+void Framebuffer::release()
+{
+    if (!colorTextures.empty())
+    {
+        glDeleteTextures((GLsizei)colorTextures.size(), colorTextures.data());
+        colorTextures.clear();
+    }
+    if (depthBuffer != 0)
+    {
+        glDeleteRenderbuffers(1, &depthBuffer);
+        depthBuffer = 0;
+    }
+    if (ID != 0)
+    {
+        glDeleteFramebuffers(1, &ID);
+        ID = 0;
+    }
+}
+
+GLuint Framebuffer::getID() const
+{
+    return ID;
+}
+
+GLuint Framebuffer::getColorTexture(int index) const
+{
+    return colorTextures[index];
+}
+
+GLenum Framebuffer::getColorFormat(int index) const
+{
+    return colorFormats[index];
+}
+
+int Framebuffer::getColorAttachmentCount() const
+{
+    return (int)colorTextures.size();
+}
+
+int Framebuffer::getWidth() const
+{
+    return width;
+}
+
+int Framebuffer::getHeight() const
+{
+    return height;
+}
+
+void Framebuffer::allocate()
+{
+    //Reallocations happen between draws, the texture bound to the active unit belongs to the caller
+    GLint boundTexture = 0;
+    glGetIntegerv(GL_TEXTURE_BINDING_2D, &boundTexture);
+
+    glGenFramebuffers(1, &ID);
+    glBindFramebuffer(GL_FRAMEBUFFER, ID);
+
+    //Color attachments
+    colorTextures.resize(colorFormats.size());
+    glGenTextures((GLsizei)colorTextures.size(), colorTextures.data());
+    std::vector<GLenum> drawBuffers;
+    for (int i = 0; i < (int)colorTextures.size(); ++i)
+    {
+        GLenum format, type;
+        pixelTransferFormat(colorFormats[i], format, type);
+
+        glBindTexture(GL_TEXTURE_2D, colorTextures[i]);
+        glTexImage2D(GL_TEXTURE_2D, 0, colorFormats[i], width, height, 0, format, type, NULL);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+
+        glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0 + i, GL_TEXTURE_2D, colorTextures[i], 0);
+        drawBuffers.push_back(GL_COLOR_ATTACHMENT0 + i);
+    }
+    glDrawBuffers((GLsizei)drawBuffers.size(), drawBuffers.data());
+
+    //Depth attachment
+    if (hasDepth)
+    {
+        glGenRenderbuffers(1, &depthBuffer);
+        glBindRenderbuffer(GL_RENDERBUFFER, depthBuffer);
+        glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH24_STENCIL8, width, height);
+        glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_RENDERBUFFER, depthBuffer);
+    }
+
+    if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+    {
+        std::cout << "ERROR::FRAMEBUFFER::NOT_COMPLETE" << std::endl;
+    }
+
+    glBindTexture(GL_TEXTURE_2D, (GLuint)boundTexture);
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+}
@@ -0,0 +1,54 @@
+#pragma once
+#ifndef FRAMEBUFFER_H
+#define FRAMEBUFFER_H
+
+#include <GL/glew.h>
+
+#include <vector>
+#include <iostream>
+
+
+/*
+    Offscreen render target.
+ 
+    Wraps a framebuffer object with one texture per color attachment (formats are given as
+    sized internal formats, e.g. GL_RGBA8 or GL_R32F) and an optional depth renderbuffer.
+    Like Shader, it is a light handle around GL names, copies refer to the same objects.
+    Call release() to free them.
+*/
+class Framebuffer
+{
+public:
+    Framebuffer();
+    Framebuffer(int width_in, int height_in, const std::vector<GLenum>& colorFormats_in = {GL_RGBA8}, bool withDepth = true);
+
+    //Binds the framebuffer for drawing and sets the viewport to cover it
+    void bind() const;
+    //Binds the window (or no framebuffer at all in headless mode)
+    static void bindDefault(int width, int height);
+    //Reallocates the attachments, previous contents are lost
+    void resize(int width_in, int height_in);
+    void release();
+
+    //Getters
+    GLuint getID() const;
+    GLuint getColorTexture(int index = 0) const;
+    GLenum getColorFormat(int index = 0) const;
+    int getColorAttachmentCount() const;
+    int getWidth() const;
+    int getHeight() const;
+
+private:
+    void allocate();
+
+private:
+    GLuint ID;
+    GLuint depthBuffer;
+    std::vector<GLuint> colorTextures;
+    std::vector<GLenum> colorFormats;
+    int width;
+    int height;
+    bool hasDepth;
+};
+
+#endif
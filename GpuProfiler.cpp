@@ -0,0 +1,236 @@
+#include "GpuProfiler.h"
+
+#include <sstream>
+#include <iomanip>
+#include <algorithm>
+
+GpuProfiler::Scope::Scope(GpuProfiler& profiler_in, const std::string& name)
+    :
+    profiler(profiler_in)
+{
+    profiler.beginPass(name);
+}
+
+GpuProfiler::Scope::~Scope()
+{
+    profiler.endPass();
+}
+
+GpuProfiler::GpuProfiler()
+    :
+    enabled(false),
+    current(0),
+    inFrame(false),
+    droppedFrames(0),
+    measuredFrames(0)
+{
+}
+
+void GpuProfiler::create()
+{
+    GLint bits = 0;
+    glGetQueryiv(GL_TIMESTAMP, GL_QUERY_COUNTER_BITS, &bits);
+    enabled = (bits > 0);
+    pools.assign(POOL_COUNT, Pool());
+    current = 0;
+    //"frame" is always the first history
+    historyOf("frame");
+}
+
+void GpuProfiler::release()
+{
+    for (Pool& pool : pools)
+    {
+        if (!pool.queries.empty())
+            glDeleteQueries((GLsizei)pool.queries.size(), pool.queries.data());
+    }
+    pools.clear();
+    enabled = false;
+}
+
+void GpuProfiler::beginFrame()
+{
+    if (!enabled)
+        return;
+
+    //This pool was filled POOL_COUNT frames ago
+    Pool& pool = pools[current];
+    if (pool.pending)
+        collect(pool);
+    pool.usedQueries = 0;
+    pool.passes.clear();
+    openPasses.clear();
+    inFrame = true;
+    beginPass("frame");
+}
+
+void GpuProfiler::endFrame()
+{
+    if (!enabled || !inFrame)
+        return;
+
+    //Unbalanced passes are closed with the frame
+    while (!openPasses.empty())
+        endPass();
+    pools[current].pending = true;
+    current = (current + 1) % POOL_COUNT;
+    inFrame = false;
+}
+
+void GpuProfiler::beginPass(const std::string& name)
+{
+    if (!enabled || !inFrame)
+        return;
+
+    Pool& pool = pools[current];
+    pool.passes.push_back({ historyOf(name), timestamp(), -1 });
+    openPasses.push_back((int)pool.passes.size() - 1);
+}
+
+void GpuProfiler::endPass()
+{
+    if (!enabled || !inFrame || openPasses.empty())
+        return;
+
+    pools[current].passes[openPasses.back()].endQuery = timestamp();
+    openPasses.pop_back();
+}
+
+bool GpuProfiler::isEnabled() const
+{
+    return enabled;
+}
+
+std::vector<GpuProfiler::PassStats> GpuProfiler::getStats() const
+{
+    std::vector<PassStats> stats;
+    for (const History& history : histories)
+    {
+        PassStats pass = { history.name, 0.0, 0.0, 0.0, 0.0, history.count };
+        if (history.count > 0)
+        {
+            int last = (history.next + HISTORY_SIZE - 1) % HISTORY_SIZE;
+            pass.last = history.samples[last];
+            pass.min = *std::min_element(history.samples.begin(), history.samples.begin() + history.count);
+            pass.max = *std::max_element(history.samples.begin(), history.samples.begin() + history.count);
+            for (int i = 0; i < history.count; ++i)
+                pass.average += history.samples[i];
+            pass.average /= history.count;
+        }
+        stats.push_back(pass);
+    }
+    return stats;
+}
+
+double GpuProfiler::getLastFrameTime() const
+{
+    if (histories.empty() || histories[0].count == 0)
+        return 0.0;
+    const History& frame = histories[0];
+    return frame.samples[(frame.next + HISTORY_SIZE - 1) % HISTORY_SIZE];
+}
+
+int GpuProfiler::getMeasuredFrames() const
+{
+    return measuredFrames;
+}
+
+std::string GpuProfiler::summary() const
+{
+    std::stringstream text;
+    text << std::fixed << std::setprecision(2);
+    bool first = true;
+    for (const PassStats& pass : getStats())
+    {
+        if (pass.samples == 0)
+            continue;
+        text << (first ? "" : " | ") << pass.name << " " << pass.average << " ms";
+        first = false;
+    }
+    return text.str();
+}
+
+void GpuProfiler::print(std::ostream& out) const
+{
+    if (!enabled)
+    {
+        out << "GPU profiler: timestamp queries are not supported" << std::endl;
+        return;
+    }
+
+    out << "GPU time (ms, last " << HISTORY_SIZE << " frames";
+    if (droppedFrames > 0)
+        out << ", " << droppedFrames << " dropped";
+    out << ")\n";
+    out << std::fixed << std::setprecision(3);
+    for (const PassStats& pass : getStats())
+    {
+        if (pass.samples == 0)
+            continue;
+        out << "  " << std::setw(12) << std::left << pass.name << std::right
+            << " last " << std::setw(8) << pass.last << " avg " << std::setw(8) << pass.average
+            << " min " << std::setw(8) << pass.min << " max " << std::setw(8) << pass.max << "\n";
+    }
+    out << std::defaultfloat << std::flush;
+}
+
+int GpuProfiler::timestamp()
+{
+    Pool& pool = pools[current];
+    if (pool.usedQueries == (int)pool.queries.size())
+    {
+        //Pools grow to the number of queries a frame needs and stay there
+        size_t grown = std::max<size_t>(pool.queries.size() * 2, 8);
+        size_t previous = pool.queries.size();
+        pool.queries.resize(grown);
+        glGenQueries((GLsizei)(grown - previous), pool.queries.data() + previous);
+    }
+    glQueryCounter(pool.queries[pool.usedQueries], GL_TIMESTAMP);
+    return pool.usedQueries++;
+}
+
+int GpuProfiler::historyOf(const std::string& name)
+{
+    auto found = historyIndex.find(name);
+    if (found != historyIndex.end())
+        return found->second;
+
+    History history;
+    history.name = name;
+    history.samples.assign(HISTORY_SIZE, 0.0);
+    histories.push_back(history);
+    historyIndex[name] = (int)histories.size() - 1;
+    return (int)histories.size() - 1;
+}
+
+void GpuProfiler::collect(Pool& pool)
+{
+    pool.pending = false;
+    if (pool.usedQueries == 0)
+        return;
+
+    //Queries complete in order, if the last one is available all of them are
+    GLint available = GL_FALSE;
+    glGetQueryObjectiv(pool.queries[pool.usedQueries - 1], GL_QUERY_RESULT_AVAILABLE, &available);
+    if (available != GL_TRUE)
+    {
+        ++droppedFrames;
+        return;
+    }
+
+    std::vector<GLuint64> times(pool.usedQueries);
+    for (int i = 0; i < pool.usedQueries; ++i)
+    {
+        glGetQueryObjectui64v(pool.queries[i], GL_QUERY_RESULT, &times[i]);
+    }
+    for (const PassRecord& pass : pool.passes)
+    {
+        if (pass.endQuery < 0)
+            continue;
+        History& history = histories[pass.history];
+        history.samples[history.next] = (times[pass.endQuery] - times[pass.beginQuery]) * 1e-6;
+        history.next = (history.next + 1) % HISTORY_SIZE;
+        history.count = std::min(history.count + 1, HISTORY_SIZE);
+    }
+    ++measuredFrames;
+}
@@ -0,0 +1,117 @@
+#pragma once
+#ifndef GPU_PROFILER_H
+#define GPU_PROFILER_H
+
+#include <GL/glew.h>
+
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <iostream>
+
+
+/*
+    Measures the GPU time of render passes with timestamp queries.
+
+    Every pass places a GL_TIMESTAMP query at its start and end (timestamps may nest, unlike
+    GL_TIME_ELAPSED), the whole frame is measured as the "frame" pass. The queries of a frame go to
+    one of POOL_COUNT pools and are read when that pool comes around again, so results are a frame
+    late but reading them never waits for the GPU. If they are still not available the frame is
+    dropped from the history instead.
+
+    Each pass keeps a rolling history of its last HISTORY_SIZE durations.
+    Like Framebuffer, it owns GL names: call create() with a current context and release() at the end.
+*/
+class GpuProfiler
+{
+public:
+    static constexpr int POOL_COUNT = 2;
+    static constexpr int HISTORY_SIZE = 120;
+
+    struct PassStats
+    {
+        std::string name;
+        //Milliseconds
+        double last;
+        double average;
+        double min;
+        double max;
+        int samples;
+    };
+
+    //Brackets a pass for the lifetime of the object
+    class Scope
+    {
+    public:
+        Scope(GpuProfiler& profiler_in, const std::string& name);
+        ~Scope();
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+    private:
+        GpuProfiler& profiler;
+    };
+
+    GpuProfiler();
+    void create();
+    void release();
+
+    void beginFrame();
+    void endFrame();
+    //Passes may nest, each beginPass needs an endPass in the same frame
+    void beginPass(const std::string& name);
+    void endPass();
+
+    //False without a context or if GL_TIMESTAMP has no bits on this driver
+    bool isEnabled() const;
+    //In the order the passes were first seen, "frame" comes first
+    std::vector<PassStats> getStats() const;
+    //Milliseconds of the latest measured frame (0 before the first one) and how many frames were measured so far
+    double getLastFrameTime() const;
+    int getMeasuredFrames() const;
+    //"frame 4.12 ms | building 3.90 ms", for the window title
+    std::string summary() const;
+    //Table of every pass
+    void print(std::ostream& out) const;
+
+private:
+    struct PassRecord
+    {
+        int history;
+        int beginQuery;
+        int endQuery;
+    };
+
+    struct Pool
+    {
+        std::vector<GLuint> queries;
+        int usedQueries = 0;
+        std::vector<PassRecord> passes;
+        bool pending = false;
+    };
+
+    struct History
+    {
+        std::string name;
+        std::vector<double> samples;
+        int next = 0;
+        int count = 0;
+    };
+
+    int timestamp();
+    int historyOf(const std::string& name);
+    void collect(Pool& pool);
+
+private:
+    bool enabled;
+    std::vector<Pool> pools;
+    int current;
+    bool inFrame;
+    //Indices into the passes of the current pool
+    std::vector<int> openPasses;
+    std::vector<History> histories;
+    std::unordered_map<std::string, int> historyIndex;
+    int droppedFrames;
+    int measuredFrames;
+};
+
+#endif
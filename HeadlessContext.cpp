@@ -0,0 +1,132 @@
+#include "HeadlessContext.h"
+
+#ifndef __APPLE__
+
+HeadlessContext::HeadlessContext()
+    :
+    display(EGL_NO_DISPLAY),
+    context(EGL_NO_CONTEXT),
+    surface(EGL_NO_SURFACE)
+{
+}
+
+bool HeadlessContext::create(int majorVersion, int minorVersion)
+{
+    //Prefer the surfaceless platform, it does not need X11/Wayland or a DRM device node
+    PFNEGLGETPLATFORMDISPLAYEXTPROC getPlatformDisplay =
+        (PFNEGLGETPLATFORMDISPLAYEXTPROC)eglGetProcAddress("eglGetPlatformDisplayEXT");
+    if (getPlatformDisplay != nullptr)
+    {
+        display = getPlatformDisplay(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, nullptr);
+    }
+    if (display == EGL_NO_DISPLAY)
+    {
+        display = eglGetDisplay(EGL_DEFAULT_DISPLAY);
+    }
+
+    EGLint eglMajor, eglMinor;
+    if (display == EGL_NO_DISPLAY || !eglInitialize(display, &eglMajor, &eglMinor))
+    {
+        std::cout << "ERROR::HEADLESS::EGL_INITIALIZATION_FAILED" << std::endl;
+        return false;
+    }
+
+    if (!eglBindAPI(EGL_OPENGL_API))
+    {
+        std::cout << "ERROR::HEADLESS::OPENGL_API_NOT_SUPPORTED" << std::endl;
+        destroy();
+        return false;
+    }
+
+    const EGLint configAttributes[] =
+    {
+        EGL_SURFACE_TYPE, EGL_PBUFFER_BIT,
+        EGL_RENDERABLE_TYPE, EGL_OPENGL_BIT,
+        EGL_RED_SIZE, 8,
+        EGL_GREEN_SIZE, 8,
+        EGL_BLUE_SIZE, 8,
+        EGL_NONE
+    };
+    EGLConfig config;
+    EGLint configCount = 0;
+    if (!eglChooseConfig(display, configAttributes, &config, 1, &configCount) || configCount == 0)
+    {
+        std::cout << "ERROR::HEADLESS::NO_SUITABLE_CONFIG" << std::endl;
+        destroy();
+        return false;
+    }
+
+    const EGLint contextAttributes[] =
+    {
+        EGL_CONTEXT_MAJOR_VERSION_KHR, majorVersion,
+        EGL_CONTEXT_MINOR_VERSION_KHR, minorVersion,
+        EGL_CONTEXT_OPENGL_PROFILE_MASK_KHR, EGL_CONTEXT_OPENGL_CORE_PROFILE_BIT_KHR,
+        EGL_NONE
+    };
+    context = eglCreateContext(display, config, EGL_NO_CONTEXT, contextAttributes);
+    if (context == EGL_NO_CONTEXT)
+    {
+        std::cout << "ERROR::HEADLESS::CONTEXT_CREATION_FAILED" << std::endl;
+        destroy();
+        return false;
+    }
+
+    //Everything is rendered into framebuffer objects, so a surface is only needed when the driver insists on one
+    if (!hasExtension("EGL_KHR_surfaceless_context"))
+    {
+        const EGLint surfaceAttributes[] = { EGL_WIDTH, 1, EGL_HEIGHT, 1, EGL_NONE };
+        surface = eglCreatePbufferSurface(display, config, surfaceAttributes);
+    }
+
+    if (!eglMakeCurrent(display, surface, surface, context))
+    {
+        std::cout << "ERROR::HEADLESS::MAKE_CURRENT_FAILED" << std::endl;
+        destroy();
+        return false;
+    }
+
+    return true;
+}
+
+void HeadlessContext::destroy()
+{
+    if (display == EGL_NO_DISPLAY)
+        return;
+
+    eglMakeCurrent(display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+    if (surface != EGL_NO_SURFACE)
+        eglDestroySurface(display, surface);
+    if (context != EGL_NO_CONTEXT)
+        eglDestroyContext(display, context);
+    eglTerminate(display);
+
+    display = EGL_NO_DISPLAY;
+    context = EGL_NO_CONTEXT;
+    surface = EGL_NO_SURFACE;
+}
+
+bool HeadlessContext::hasExtension(const char* extension) const
+{
+    const char* extensions = eglQueryString(display, EGL_EXTENSIONS);
+    if (extensions == nullptr)
+        return false;
+
+    //Extension names are separated by spaces, make sure we do not match a prefix of another name
+    std::string list = std::string(" ") + extensions + " ";
+    return list.find(std::string(" ") + extension + " ") != std::string::npos;
+}
+
+#else
+
+//EGL is not available on macOS, the headless mode is only supported on Linux render nodes
+HeadlessContext::HeadlessContext() {}
+
+bool HeadlessContext::create(int majorVersion, int minorVersion)
+{
+    std::cout << "ERROR::HEADLESS::NOT_SUPPORTED_ON_THIS_PLATFORM" << std::endl;
+    return false;
+}
+
+void HeadlessContext::destroy() {}
+
+#endif
@@ -0,0 +1,41 @@
+#pragma once
+#ifndef HEADLESS_CONTEXT_H
+#define HEADLESS_CONTEXT_H
+
+#ifndef __APPLE__
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+#endif
+
+#include <string>
+#include <iostream>
+
+
+/*
+    OpenGL context without a window.
+ 
+    Used on render nodes that have no display server. The context is created through EGL,
+    preferring the Mesa surfaceless platform (works with llvmpipe and with GPU drivers alike).
+    Nothing is ever presented, so every frame has to be rendered into a Framebuffer.
+*/
+class HeadlessContext
+{
+public:
+    HeadlessContext();
+    //Creates a core profile context of the given version and makes it current
+    bool create(int majorVersion = 4, int minorVersion = 1);
+    void destroy();
+
+private:
+#ifndef __APPLE__
+    bool hasExtension(const char* extension) const;
+
+private:
+    EGLDisplay display;
+    EGLContext context;
+    //Only used if the driver does not support surfaceless contexts
+    EGLSurface surface;
+#endif
+};
+
+#endif
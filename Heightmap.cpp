@@ -0,0 +1,111 @@
+#include "Heightmap.h"
+#include "Framebuffer.h"
+
+void Heightmap::Uniforms::resolve(const Shader& shader)
+{
+    bake = shader.uniform<int>("heightmap_bake");
+    levels = shader.uniform<int>("heightmap_levels");
+    texel = shader.uniform<float>("heightmap_texel");
+    texture = shader.uniform<int>("heightmap_texture");
+    shader.use();
+    texture.set(TEXTURE_UNIT);
+}
+
+bool Heightmap::Uniforms::isActive() const
+{
+    return bake.isActive();
+}
+
+Heightmap::Heightmap()
+    :
+    texture(0),
+    levelCount(0)
+{
+}
+
+void Heightmap::bake(const Shader& shader, const Uniforms& uniforms, GLuint quad)
+{
+    release();
+    if (!reduceShader.isValid())
+    {
+        reduceShader = Shader("Shaders/heightmap/heightmap_vertex.glsl", "Shaders/heightmap/heightmap_fragment.glsl");
+        reduceShader.use();
+        reduceShader.uniform<int>("heightmap_texture").set(TEXTURE_UNIT);
+        reduceLevel = reduceShader.uniform<int>("heightmap_level");
+    }
+
+    levelCount = 1;
+    while ((SIZE >> levelCount) > 0)
+        ++levelCount;
+    glGenTextures(1, &texture);
+    bind();
+    for (int level = 0; level < levelCount; ++level)
+        glTexImage2D(GL_TEXTURE_2D, level, GL_RGBA32F, SIZE >> level, SIZE >> level, 0, GL_RGBA, GL_FLOAT, NULL);
+    //Only read with texelFetch
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST_MIPMAP_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+
+    //Every level is drawn into the corner of the scratch target and copied into its place
+    Framebuffer scratch(SIZE, SIZE, {GL_RGBA32F}, false);
+    scratch.bind();
+    glBindVertexArray(quad);
+    shader.use();
+    uniforms.texel.set(TEXEL_SIZE);
+    uniforms.bake.set(SIZE);
+    glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0);
+    uniforms.bake.set(0);
+    glCopyTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, 0, 0, SIZE, SIZE);
+
+    reduceShader.use();
+    for (int level = 1; level < levelCount; ++level)
+    {
+        int size = SIZE >> level;
+        reduceLevel.set(level - 1);
+        glViewport(0, 0, size, size);
+        glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0);
+        glCopyTexSubImage2D(GL_TEXTURE_2D, level, 0, 0, 0, 0, size, size);
+    }
+    scratch.release();
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+}
+
+void Heightmap::enable(const Shader& shader, const Uniforms& uniforms) const
+{
+    shader.use();
+    uniforms.texel.set(TEXEL_SIZE);
+    uniforms.levels.set(getLevelCount());
+}
+
+void Heightmap::disable(const Shader& shader, const Uniforms& uniforms)
+{
+    shader.use();
+    uniforms.levels.set(0);
+}
+
+void Heightmap::bind() const
+{
+    glActiveTexture(GL_TEXTURE0 + TEXTURE_UNIT);
+    glBindTexture(GL_TEXTURE_2D, texture);
+}
+
+void Heightmap::release()
+{
+    levelCount = 0;
+    if (texture != 0)
+    {
+        glDeleteTextures(1, &texture);
+        texture = 0;
+    }
+}
+
+bool Heightmap::isBaked() const
+{
+    return texture != 0;
+}
+
+int Heightmap::getLevelCount() const
+{
+    return levelCount;
+}
@@ -0,0 +1,69 @@
+#pragma once
+#ifndef HEIGHTMAP_H
+#define HEIGHTMAP_H
+
+#include <GL/glew.h>
+
+#include "Shader.h"
+#include "ConePrepass.h"
+
+
+/*
+    Min/max heightmap pyramid of a heightfield scene (Shaders/heightmap.glsl).
+
+    bake() draws the scene shader once into level 0, a SIZE x SIZE RGBA32F texture centered on the
+    origin of the xz plane, where every fragment bounds the scene over its TEXEL_SIZE wide square.
+    Each further level is reduced from the one below by Shaders/heightmap/heightmap_fragment.glsl,
+    down to a single texel that bounds the whole map. The levels are drawn into a scratch target and
+    copied into the mip chain, so the pyramid is never read and drawn into at once.
+    The scene then traces its primary rays through the pyramid and skips the space above it with
+    texture fetches instead of distance evaluations. The bounds do not change over time, the pyramid
+    is baked once.
+
+    Like Framebuffer, it is a light handle around GL names. Call release() to free them.
+*/
+class Heightmap
+{
+public:
+    //Level 0 texels per side, the map covers SIZE * TEXEL_SIZE world units per side
+    static constexpr int SIZE = 1024;
+    static constexpr float TEXEL_SIZE = 16.0f;
+    //Texture unit of the pyramid, between the units of the scene textures and the cone prepass
+    static constexpr int TEXTURE_UNIT = ConePrepass::TEXTURE_UNIT - 1;
+
+    //Uniforms of heightmap.glsl in one scene shader
+    struct Uniforms
+    {
+        Uniform<int> bake;
+        Uniform<int> levels;
+        Uniform<float> texel;
+        Uniform<int> texture;
+        void resolve(const Shader& shader);
+        //Whether the shader can bake a heightmap at all
+        bool isActive() const;
+    };
+
+    Heightmap();
+    /*
+        Allocates the pyramid and bakes it with the scene shader, needs a current context.
+        Leaves no framebuffer bound, the caller binds its own render target again afterwards.
+    */
+    void bake(const Shader& shader, const Uniforms& uniforms, GLuint quad);
+    //Lets the shader trace through the pyramid, which bind() has to bind for its draws
+    void enable(const Shader& shader, const Uniforms& uniforms) const;
+    //The shader marches without the pyramid
+    static void disable(const Shader& shader, const Uniforms& uniforms);
+    void bind() const;
+    void release();
+
+    bool isBaked() const;
+    int getLevelCount() const;
+
+private:
+    Shader reduceShader;
+    Uniform<int> reduceLevel;
+    GLuint texture;
+    int levelCount;
+};
+
+#endif
@@ -0,0 +1,31 @@
+#include "ImageIO.h"
+
+#include <vector>
+
+bool writePPM(const std::string& path, const unsigned char* pixels, int width, int height, int channels, bool flipVertical)
+{
+    std::ofstream file(path, std::ios::binary);
+    if (!file)
+    {
+        std::cout << "ERROR::IMAGE::FILE_NOT_SUCCESSFULLY_OPENED->" << path << std::endl;
+        return false;
+    }
+
+    file << "P6\n" << width << " " << height << "\n255\n";
+
+    std::vector<unsigned char> row(width * 3);
+    for (int y = 0; y < height; ++y)
+    {
+        int sourceRow = flipVertical ? (height - 1 - y) : y;
+        const unsigned char* source = pixels + (size_t)sourceRow * width * channels;
+        for (int x = 0; x < width; ++x)
+        {
+            row[x * 3 + 0] = source[x * channels + 0];
+            row[x * 3 + 1] = source[x * channels + (channels > 1 ? 1 : 0)];
+            row[x * 3 + 2] = source[x * channels + (channels > 2 ? 2 : 0)];
+        }
+        file.write((const char*)row.data(), row.size());
+    }
+
+    return (bool)file;
+}
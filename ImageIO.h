@@ -0,0 +1,16 @@
+#pragma once
+#ifndef IMAGE_IO_H
+#define IMAGE_IO_H
+
+#include <string>
+#include <fstream>
+#include <iostream>
+
+
+/*
+    Writes 8-bit pixels as a binary PPM (P6) image. Only the first three channels are stored.
+    OpenGL hands back rows bottom to top, set flipVertical for pixels read from a framebuffer.
+*/
+bool writePPM(const std::string& path, const unsigned char* pixels, int width, int height, int channels, bool flipVertical);
+
+#endif
@@ -0,0 +1,164 @@
+#include "ProgramBinaryCache.h"
+
+#include <fstream>
+#include <sstream>
+#include <iostream>
+#include <iomanip>
+#include <filesystem>
+#include <cstdio>
+#include <random>
+
+std::string ProgramBinaryCache::directory = "shader_cache";
+
+namespace
+{
+    //"SDFB" + layout version
+    constexpr uint32_t BINARY_MAGIC = 0x42464453;
+    constexpr uint32_t BINARY_VERSION = 1;
+
+    struct BinaryHeader
+    {
+        uint32_t magic;
+        uint32_t version;
+        uint32_t format;
+        uint32_t length;
+        //Of the binary itself, catches truncated files
+        uint64_t checksum;
+    };
+
+    //FNV-1a
+    uint64_t hashBytes(const void* data, size_t size, uint64_t hash = 14695981039346656037ull)
+    {
+        const unsigned char* bytes = (const unsigned char*)data;
+        for (size_t i = 0; i < size; ++i)
+        {
+            hash ^= bytes[i];
+            hash *= 1099511628211ull;
+        }
+        return hash;
+    }
+
+    uint64_t hashString(const std::string& text, uint64_t hash)
+    {
+        //Hash the length as well so ("ab", "c") and ("a", "bc") differ
+        uint64_t length = text.size();
+        hash = hashBytes(&length, sizeof(length), hash);
+        return hashBytes(text.data(), text.size(), hash);
+    }
+
+    std::string glString(GLenum name)
+    {
+        const GLubyte* value = glGetString(name);
+        return value ? (const char*)value : "";
+    }
+}
+
+void ProgramBinaryCache::setDirectory(const std::string& directory_in)
+{
+    directory = directory_in;
+}
+
+bool ProgramBinaryCache::isEnabled()
+{
+    return !directory.empty();
+}
+
+std::string ProgramBinaryCache::makeKey(const std::vector<std::string>& sources)
+{
+    uint64_t hash = hashBytes(&BINARY_VERSION, sizeof(BINARY_VERSION));
+    hash = hashString(glString(GL_VENDOR), hash);
+    hash = hashString(glString(GL_RENDERER), hash);
+    hash = hashString(glString(GL_VERSION), hash);
+    hash = hashString(glString(GL_SHADING_LANGUAGE_VERSION), hash);
+    for (const std::string& source : sources)
+    {
+        hash = hashString(source, hash);
+    }
+
+    std::stringstream key;
+    key << std::hex << std::setw(16) << std::setfill('0') << hash;
+    return key.str();
+}
+
+bool ProgramBinaryCache::load(GLuint program, const std::string& key)
+{
+    if (!isEnabled() || !supported())
+        return false;
+
+    std::ifstream file(pathOf(key), std::ios::binary);
+    if (!file)
+        return false;
+
+    BinaryHeader header;
+    if (!file.read((char*)&header, sizeof(header)) || header.magic != BINARY_MAGIC || header.version != BINARY_VERSION)
+        return false;
+
+    std::vector<char> binary(header.length);
+    if (!file.read(binary.data(), binary.size()) || hashBytes(binary.data(), binary.size()) != header.checksum)
+        return false;
+
+    glProgramBinary(program, header.format, binary.data(), (GLsizei)binary.size());
+    GLint linked = GL_FALSE;
+    glGetProgramiv(program, GL_LINK_STATUS, &linked);
+    //The driver may reject binaries of an older build even if the version strings match
+    return linked == GL_TRUE;
+}
+
+bool ProgramBinaryCache::store(GLuint program, const std::string& key)
+{
+    if (!isEnabled() || !supported())
+        return false;
+
+    GLint length = 0;
+    glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length);
+    if (length <= 0)
+        return false;
+
+    std::vector<char> binary(length);
+    GLenum format = 0;
+    glGetProgramBinary(program, length, &length, &format, binary.data());
+    binary.resize(length);
+
+    std::error_code error;
+    std::filesystem::create_directories(directory, error);
+
+    BinaryHeader header = { BINARY_MAGIC, BINARY_VERSION, format, (uint32_t)binary.size(),
+                            hashBytes(binary.data(), binary.size()) };
+    /*
+        Write to a temporary file first so a concurrent launch never sees a partial binary. The name is
+        unique per store, launches storing the same key each rename their own complete file into place.
+    */
+    std::string path = pathOf(key);
+    std::ostringstream suffix;
+    suffix << std::hex << std::random_device()();
+    std::string temporaryPath = path + "." + suffix.str() + ".tmp";
+    {
+        std::ofstream file(temporaryPath, std::ios::binary | std::ios::trunc);
+        if (!file.write((const char*)&header, sizeof(header)) || !file.write(binary.data(), binary.size()))
+        {
+            std::cout << "ERROR::SHADER::BINARY_NOT_SUCCESSFULLY_WRITTEN->" << path << std::endl;
+            file.close();
+            std::remove(temporaryPath.c_str());
+            return false;
+        }
+    }
+    std::filesystem::rename(temporaryPath, path, error);
+    if (error)
+    {
+        std::remove(temporaryPath.c_str());
+        return false;
+    }
+    return true;
+}
+
+std::string ProgramBinaryCache::pathOf(const std::string& key)
+{
+    return directory + "/" + key + ".bin";
+}
+
+bool ProgramBinaryCache::supported()
+{
+    GLint formats = 0;
+    glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formats);
+    return formats > 0;
+}
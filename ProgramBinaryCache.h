@@ -0,0 +1,41 @@
+#pragma once
+#ifndef PROGRAM_BINARY_CACHE_H
+#define PROGRAM_BINARY_CACHE_H
+
+#include <GL/glew.h>
+
+#include <string>
+#include <vector>
+#include <cstdint>
+
+
+/*
+    Stores linked programs on disk (glGetProgramBinary) so later launches skip compilation.
+
+    The key hashes the preprocessed sources of every stage together with the vendor, renderer and
+    version strings, so an edited shader or a driver update selects a different file and stale
+    binaries are never loaded. A binary the driver rejects is ignored and the program is compiled
+    from source as usual.
+*/
+class ProgramBinaryCache
+{
+public:
+    //Directory the binaries are kept in, an empty path disables the cache
+    static void setDirectory(const std::string& directory_in);
+    static bool isEnabled();
+
+    //Needs a current context, the driver strings are part of the key
+    static std::string makeKey(const std::vector<std::string>& sources);
+    //Loads the binary stored under key into program. False if there is none or the driver rejected it.
+    static bool load(GLuint program, const std::string& key);
+    //program must be linked with GL_PROGRAM_BINARY_RETRIEVABLE_HINT set
+    static bool store(GLuint program, const std::string& key);
+
+private:
+    static std::string pathOf(const std::string& key);
+    static bool supported();
+
+    static std::string directory;
+};
+
+#endif
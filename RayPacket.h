@@ -0,0 +1,49 @@
+#pragma once
+#ifndef RAY_PACKET_H
+#define RAY_PACKET_H
+
+#include <glm/glm.hpp>
+
+#include "SimdLanes.h"
+#include "hg_sdf.h"
+
+using PacketFloat = simd::FloatN;
+using PacketMask = simd::MaskN;
+using PacketVec2 = hg::vec2<PacketFloat>;
+using PacketVec3 = hg::vec3<PacketFloat>;
+
+//Number of rays marched together
+static constexpr int PACKET_SIZE = PacketFloat::WIDTH;
+
+/*
+    Rays marched together by the CPU renderer in structure of arrays layout.
+ 
+    object holds the same vec2(distance travelled, material ID) as the scalar ray_march,
+    active marks the lanes that have neither hit nor left the scene yet.
+*/
+struct RayPacket
+{
+    PacketVec3 origin;
+    PacketVec3 direction;
+    PacketVec2 object;
+    PacketMask active;
+};
+
+//Lane access for the parts that stay scalar
+inline glm::vec3 getLane(const PacketVec3& v, int lane)
+{
+    alignas(64) float x[PACKET_SIZE], y[PACKET_SIZE], z[PACKET_SIZE];
+    v.x.store(x);
+    v.y.store(y);
+    v.z.store(z);
+    return glm::vec3(x[lane], y[lane], z[lane]);
+}
+
+inline float getLane(PacketFloat v, int lane)
+{
+    alignas(64) float x[PACKET_SIZE];
+    v.store(x);
+    return x[lane];
+}
+
+#endif
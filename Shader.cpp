@@ -1,50 +1,38 @@
 #include "Shader.h"
 
-Shader::Shader() {}
+Shader::Shader() : ID(0), valid(false) {}
 
 //Going to read shaders from the files
-Shader::Shader(const char * vertexPath, const char * fragmentPath, const char* geometryPath)
+Shader::Shader(const char * vertexPath, const char * fragmentPath, const char* geometryPath, const std::vector<std::string>& defines)
 {
-	//Retrieve and store the shader codes
+	//Retrieve the shader codes, resolving #include directives
 	std::string vertexCode;
 	std::string fragmentCode;
 	std::string geometryCode;
-	std::ifstream vShaderFile;
-	std::ifstream fShaderFile;
-	std::ifstream gShaderFile;
-	//Ensure ifstream objects can throw exceptions. Set the exception masks
-	vShaderFile.exceptions(std::ifstream::failbit | std::ifstream::badbit);
-	fShaderFile.exceptions(std::ifstream::failbit | std::ifstream::badbit);
-	gShaderFile.exceptions(std::ifstream::failbit | std::ifstream::badbit);
-	try
+	ShaderPreprocessor vertexPreprocessor, fragmentPreprocessor, geometryPreprocessor;
+	vertexPreprocessor.setDefines(defines);
+	fragmentPreprocessor.setDefines(defines);
+	geometryPreprocessor.setDefines(defines);
+	bool sourcesRead = vertexPreprocessor.process(vertexPath, vertexCode);
+	sourcesRead = fragmentPreprocessor.process(fragmentPath, fragmentCode) && sourcesRead;
+	//If present, also load the geometry shader
+	if (geometryPath != nullptr)
 	{
-		//Open the files
-		vShaderFile.open(vertexPath);
-		fShaderFile.open(fragmentPath);
-		std::stringstream vShaderStream, fShaderStream;
-		//Read file's buffer contents into the streams
-		vShaderStream << vShaderFile.rdbuf();
-		fShaderStream << fShaderFile.rdbuf();
-		//Close the files
-		vShaderFile.close();
-		fShaderFile.close();
-		//Extract the strings from the streams
-		vertexCode = vShaderStream.str();
-		fragmentCode = fShaderStream.str();
-		//If present, also load the geometry shader
-		if (geometryPath != nullptr)
-		{
-			gShaderFile.open(geometryPath);
-			std::stringstream gShaderStream;
-			gShaderStream << gShaderFile.rdbuf();
-			gShaderFile.close();
-			geometryCode = gShaderStream.str();
-		}
-
+		sourcesRead = geometryPreprocessor.process(geometryPath, geometryCode) && sourcesRead;
 	}
-	catch (std::ifstream::failure fail)
+
+	//Warm start: a binary linked from exactly these sources by this driver skips compilation
+	ID = glCreateProgram();
+	std::string cacheKey;
+	if (sourcesRead && ProgramBinaryCache::isEnabled())
 	{
-		std::cout << "ERROR::SHADER::FILE_NOT_SUCCESSFULLY_READ->" << fail.what() << std::endl;
+		cacheKey = ProgramBinaryCache::makeKey({ vertexCode, fragmentCode, geometryCode });
+		if (ProgramBinaryCache::load(ID, cacheKey))
+		{
+			valid = true;
+			introspectUniforms();
+			return;
+		}
 	}
 
 	const char* vShaderCode = vertexCode.c_str();
@@ -56,14 +44,14 @@ Shader::Shader(const char * vertexPath, const char * fragmentPath, const char* g
 	glShaderSource(vertex, 1, &vShaderCode, NULL);
 	glCompileShader(vertex);
 	//Check errors
-	checkCompileErrors(vertex, "VERTEX");
+	checkCompileErrors(vertex, "VERTEX", &vertexPreprocessor);
 
 	//Compile the fragment shader
 	fragment = glCreateShader(GL_FRAGMENT_SHADER);
 	glShaderSource(fragment, 1, &fShaderCode, NULL);
 	glCompileShader(fragment);
 	//Check errors
-	checkCompileErrors(fragment, "FRAGMENT");
+	checkCompileErrors(fragment, "FRAGMENT", &fragmentPreprocessor);
 	//If present compile the geometry shader
 	GLuint geometry;
 	if (geometryPath != nullptr)
@@ -72,19 +60,33 @@ Shader::Shader(const char * vertexPath, const char * fragmentPath, const char* g
 		geometry = glCreateShader(GL_GEOMETRY_SHADER);
 		glShaderSource(geometry, 1, &gShaderCode, NULL);
 		glCompileShader(geometry);
-		checkCompileErrors(geometry, "GEOMETRY");
+		checkCompileErrors(geometry, "GEOMETRY", &geometryPreprocessor);
 	}
-	//Create the shader program
-	ID = glCreateProgram();
+	//Link the shader program
 	glAttachShader(ID, vertex);
 	glAttachShader(ID, fragment);
 	if (geometryPath != nullptr)
 	{
 		glAttachShader(ID, geometry);
 	}
+	if (!cacheKey.empty())
+	{
+		glProgramParameteri(ID, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+	}
 	glLinkProgram(ID);
 	//Check linking errors
 	checkCompileErrors(ID, "PROGRAM");
+	GLint linked;
+	glGetProgramiv(ID, GL_LINK_STATUS, &linked);
+	valid = (linked == GL_TRUE);
+	if (valid && !cacheKey.empty())
+	{
+		ProgramBinaryCache::store(ID, cacheKey);
+	}
+	if (valid)
+	{
+		introspectUniforms();
+	}
 
 	//After linking the program we dont need shaders anymore.
 	glDeleteShader(vertex);
@@ -96,64 +98,79 @@ Shader::Shader(const char * vertexPath, const char * fragmentPath, const char* g
 
 }
 
-void Shader::use()
+void Shader::use() const
 {
 	glUseProgram(ID);
 }
 
 void Shader::setBool(const std::string & name, bool value) const
 {
-	glUniform1i(glGetUniformLocation(ID, name.c_str()), (int)value);
+	glUniform1i(getUniformLocation(name), (int)value);
 }
 
 void Shader::setInt(const std::string & name, int value) const
 {
-	glUniform1i(glGetUniformLocation(ID, name.c_str()), value);
+	glUniform1i(getUniformLocation(name), value);
 }
 
 void Shader::setFloat(const std::string & name, float value) const
 {
-	glUniform1f(glGetUniformLocation(ID, name.c_str()), value);
+	glUniform1f(getUniformLocation(name), value);
 }
 
 void Shader::setVec2(const std::string & name, const glm::vec2& value) const
 {
-	glUniform2fv(glGetUniformLocation(ID, name.c_str()), 1, &value[0]);
+	glUniform2fv(getUniformLocation(name), 1, &value[0]);
 }
 
 void Shader::setVec2(const std::string & name, float x, float y) const
 {
-	glUniform2f(glGetUniformLocation(ID, name.c_str()), x, y);
+	glUniform2f(getUniformLocation(name), x, y);
 }
 
 void Shader::setVec3(const std::string & name, const glm::vec3 & value) const
 {
-	glUniform3fv(glGetUniformLocation(ID, name.c_str()), 1, &value[0]);
+	glUniform3fv(getUniformLocation(name), 1, &value[0]);
 }
 
 void Shader::setVec3(const std::string & name, float x, float y, float z) const
 {
-	glUniform3f(glGetUniformLocation(ID, name.c_str()), x, y, z);
+	glUniform3f(getUniformLocation(name), x, y, z);
 }
 
 void Shader::setVec4(const std::string & name, const glm::vec4 & value) const
 {
-	glUniform4fv(glGetUniformLocation(ID, name.c_str()), 1, &value[0]);
+	glUniform4fv(getUniformLocation(name), 1, &value[0]);
 }
 
 void Shader::setVec4(const std::string & name, float x, float y, float z, float w) const
 {
-	glUniform4f(glGetUniformLocation(ID, name.c_str()), x, y, z, w);
+	glUniform4f(getUniformLocation(name), x, y, z, w);
 }
 
 void Shader::setMat3(const std::string & name, const glm::mat3 & matrix) const
 {
-	glUniformMatrix3fv(glGetUniformLocation(ID, name.c_str()), 1, GL_FALSE, glm::value_ptr(matrix));
+	glUniformMatrix3fv(getUniformLocation(name), 1, GL_FALSE, glm::value_ptr(matrix));
 }
 
 void Shader::setMat4(const std::string & name, const glm::mat4 & matrix) const
 {
-	glUniformMatrix4fv(glGetUniformLocation(ID, name.c_str()), 1, GL_FALSE, glm::value_ptr(matrix));
+	glUniformMatrix4fv(getUniformLocation(name), 1, GL_FALSE, glm::value_ptr(matrix));
+}
+
+bool Shader::bindUniformBlock(const std::string& name, GLuint binding) const
+{
+	GLuint index = glGetUniformBlockIndex(ID, name.c_str());
+	if (index == GL_INVALID_INDEX)
+		return false;
+	glUniformBlockBinding(ID, index, binding);
+	return true;
+}
+
+GLint Shader::getUniformLocation(const std::string& name) const
+{
+	const UniformInfo* info = findUniform(name);
+	return (info != nullptr) ? info->location : -1;
 }
 
 GLuint Shader::getID() const
@@ -161,17 +178,31 @@ GLuint Shader::getID() const
 	return ID;
 }
 
-void Shader::checkCompileErrors(GLuint IDtoCheck, std::string type) const
+bool Shader::isValid() const
+{
+	return valid;
+}
+
+void Shader::checkCompileErrors(GLuint IDtoCheck, std::string type, const ShaderPreprocessor* preprocessor) const
 {
 	int success;
-	char infoLog[1024];
+	int logLength = 0;
+	std::string infoLog;
 	if (type != "PROGRAM") 
 	{
 		//Check shader errors
 		glGetShaderiv(IDtoCheck, GL_COMPILE_STATUS, &success);
 		if (!success)
 		{
-			glGetShaderInfoLog(IDtoCheck, 1024, NULL, infoLog);
+			glGetShaderiv(IDtoCheck, GL_INFO_LOG_LENGTH, &logLength);
+			infoLog.resize(std::max(logLength, 1));
+			glGetShaderInfoLog(IDtoCheck, (GLsizei)infoLog.size(), NULL, &infoLog[0]);
+			infoLog.resize(std::max(logLength - 1, 0));
+			//Report file names instead of source string numbers
+			if (preprocessor != nullptr)
+			{
+				infoLog = preprocessor->remapLog(infoLog);
+			}
 			std::cout << "ERROR::SHADER_COMPILATION_ERROR of type " << type << "\n" << infoLog << std::endl;
 		}
 	}
@@ -181,10 +212,77 @@ void Shader::checkCompileErrors(GLuint IDtoCheck, std::string type) const
 		glGetProgramiv(IDtoCheck, GL_LINK_STATUS, &success);
 		if (!success)
 		{
-			glGetProgramInfoLog(IDtoCheck, 1024, NULL, infoLog);
+			glGetProgramiv(IDtoCheck, GL_INFO_LOG_LENGTH, &logLength);
+			infoLog.resize(std::max(logLength, 1));
+			glGetProgramInfoLog(IDtoCheck, (GLsizei)infoLog.size(), NULL, &infoLog[0]);
+			infoLog.resize(std::max(logLength - 1, 0));
 			std::cout << "ERROR::PROGRAM_LINKING_ERROR of type " << type << "\n" << infoLog << std::endl;
 		}
 
 	}
 }
 
+void Shader::introspectUniforms()
+{
+	uniforms.clear();
+	GLint count = 0;
+	GLint maxNameLength = 0;
+	glGetProgramiv(ID, GL_ACTIVE_UNIFORMS, &count);
+	glGetProgramiv(ID, GL_ACTIVE_UNIFORM_MAX_LENGTH, &maxNameLength);
+	std::vector<char> nameBuffer(std::max(maxNameLength, 1));
+	for (GLint i = 0; i < count; ++i)
+	{
+		GLsizei length = 0;
+		GLint size = 0;
+		GLenum type = 0;
+		glGetActiveUniform(ID, (GLuint)i, (GLsizei)nameBuffer.size(), &length, &size, &type, nameBuffer.data());
+		std::string name(nameBuffer.data(), length);
+		GLint location = glGetUniformLocation(ID, name.c_str());
+		//Uniform block members have no location
+		if (location < 0)
+			continue;
+
+		//Arrays are reported as "name[0]"
+		size_t bracket = name.find('[');
+		if (bracket == std::string::npos)
+		{
+			uniforms[name] = { location, type };
+			continue;
+		}
+		std::string base = name.substr(0, bracket);
+		uniforms[base] = { location, type };
+		uniforms[base + "[0]"] = { location, type };
+		for (GLint element = 1; element < size; ++element)
+		{
+			std::string elementName = base + "[" + std::to_string(element) + "]";
+			uniforms[elementName] = { glGetUniformLocation(ID, elementName.c_str()), type };
+		}
+	}
+}
+
+const Shader::UniformInfo* Shader::findUniform(const std::string& name) const
+{
+	auto found = uniforms.find(name);
+	return (found != uniforms.end()) ? &found->second : nullptr;
+}
+
+bool Shader::typeMatches(GLenum type, const int*)
+{
+	//Samplers are set through integers as well
+	switch (type)
+	{
+		case GL_INT:
+		case GL_SAMPLER_1D:
+		case GL_SAMPLER_2D:
+		case GL_SAMPLER_3D:
+		case GL_SAMPLER_CUBE:
+		case GL_SAMPLER_2D_SHADOW:
+		case GL_SAMPLER_2D_ARRAY:
+		case GL_SAMPLER_BUFFER:
+		case GL_INT_SAMPLER_2D:
+		case GL_UNSIGNED_INT_SAMPLER_2D:
+			return true;
+		default:
+			return false;
+	}
+}
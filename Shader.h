@@ -11,16 +11,56 @@
 #include <fstream>
 #include <sstream>
 #include <iostream>
+#include <algorithm>
+#include <vector>
+#include <unordered_map>
 
+#include "ShaderPreprocessor.h"
+#include "ProgramBinaryCache.h"
+
+
+// glUniform* overloads picked by the handle type
+inline void uploadUniform(GLint location, bool value) { glUniform1i(location, (int)value); }
+inline void uploadUniform(GLint location, int value) { glUniform1i(location, value); }
+inline void uploadUniform(GLint location, float value) { glUniform1f(location, value); }
+inline void uploadUniform(GLint location, const glm::vec2& value) { glUniform2fv(location, 1, &value[0]); }
+inline void uploadUniform(GLint location, const glm::vec3& value) { glUniform3fv(location, 1, &value[0]); }
+inline void uploadUniform(GLint location, const glm::vec4& value) { glUniform4fv(location, 1, &value[0]); }
+inline void uploadUniform(GLint location, const glm::mat3& value) { glUniformMatrix3fv(location, 1, GL_FALSE, glm::value_ptr(value)); }
+inline void uploadUniform(GLint location, const glm::mat4& value) { glUniformMatrix4fv(location, 1, GL_FALSE, glm::value_ptr(value)); }
+
+/*
+	Pre-resolved uniform location, obtained once through Shader::uniform<T>(name).
+	Setting it is a single glUniform call, no string is built or looked up.
+	Like the set functions of Shader, the program has to be in use.
+	Handles of uniforms the program does not have (or optimized away) are ignored when set.
+*/
+template<typename T>
+class Uniform
+{
+public:
+	Uniform() : location(-1) {}
+	explicit Uniform(GLint location_in) : location(location_in) {}
+	void set(const T& value) const
+	{
+		if (location >= 0)
+			uploadUniform(location, value);
+	}
+	bool isActive() const { return location >= 0; }
+	GLint getLocation() const { return location; }
+private:
+	GLint location;
+};
 
 class Shader
 {
 public:
     Shader();
-	// constructor reads and builds the shader
-	Shader(const char* vertexPath, const char* fragmentPath, const char* geometryPath = nullptr);
+	// constructor reads and builds the shader, defines ("NAME" or "NAME VALUE") are inserted into every stage
+	Shader(const char* vertexPath, const char* fragmentPath, const char* geometryPath = nullptr,
+	       const std::vector<std::string>& defines = {});
 	// use/activate the shader
-	void use();
+	void use() const;
 	// utility uniform functions. Note that to call these functions, first you have to activate the shader program
 	void setBool(const std::string &name, bool value) const;
 	void setInt(const std::string &name, int value) const;
@@ -33,13 +73,56 @@ public:
 	void setVec4(const std::string& name, float x, float y, float z, float w) const;
 	void setMat3(const std::string& name, const glm::mat3& matrix) const;
 	void setMat4(const std::string& name, const glm::mat4& matrix) const;
+	// typed handle of an active uniform, an inactive handle if it does not exist or the type does not match
+	template<typename T>
+	Uniform<T> uniform(const std::string& name) const;
+	// assigns a uniform block of the program to a buffer binding point (GLSL 4.10 has no layout(binding))
+	bool bindUniformBlock(const std::string& name, GLuint binding) const;
+	// location from the table built after linking, -1 for unknown names. No driver call involved
+	GLint getUniformLocation(const std::string& name) const;
 	GLuint getID() const;
+	// false if a stage failed to load or the program failed to link
+	bool isValid() const;
 private:
-	void checkCompileErrors(GLuint shader, std::string type) const;
+	struct UniformInfo
+	{
+		GLint location;
+		GLenum type;
+	};
+	// preprocessor maps source string numbers in the log back to file names
+	void checkCompileErrors(GLuint shader, std::string type, const ShaderPreprocessor* preprocessor = nullptr) const;
+	// reads every active uniform of the linked program into the table
+	void introspectUniforms();
+	const UniformInfo* findUniform(const std::string& name) const;
+	static bool typeMatches(GLenum type, const bool*) { return type == GL_BOOL; }
+	static bool typeMatches(GLenum type, const int*);
+	static bool typeMatches(GLenum type, const float*) { return type == GL_FLOAT; }
+	static bool typeMatches(GLenum type, const glm::vec2*) { return type == GL_FLOAT_VEC2; }
+	static bool typeMatches(GLenum type, const glm::vec3*) { return type == GL_FLOAT_VEC3; }
+	static bool typeMatches(GLenum type, const glm::vec4*) { return type == GL_FLOAT_VEC4; }
+	static bool typeMatches(GLenum type, const glm::mat3*) { return type == GL_FLOAT_MAT3; }
+	static bool typeMatches(GLenum type, const glm::mat4*) { return type == GL_FLOAT_MAT4; }
 private:
 	// the program ID
 	GLuint ID;
+	bool valid;
+	// active uniforms by name, array elements are listed as "name[i]" and the first one also as "name"
+	std::unordered_map<std::string, UniformInfo> uniforms;
 
 };
 
+template<typename T>
+Uniform<T> Shader::uniform(const std::string& name) const
+{
+	const UniformInfo* info = findUniform(name);
+	if (info == nullptr)
+		return Uniform<T>();
+	if (!typeMatches(info->type, (const T*)nullptr))
+	{
+		std::cout << "ERROR::SHADER::UNIFORM_TYPE_MISMATCH->" << name << std::endl;
+		return Uniform<T>();
+	}
+	return Uniform<T>(info->location);
+}
+
 #endif
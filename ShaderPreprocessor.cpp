@@ -0,0 +1,518 @@
+#include "ShaderPreprocessor.h"
+
+#include <fstream>
+#include <sstream>
+#include <iostream>
+#include <regex>
+#include <cctype>
+#include <algorithm>
+#include <unordered_set>
+
+std::unordered_map<std::string, ShaderPreprocessor::SourceFilePtr> ShaderPreprocessor::cache;
+
+//Collapses "." and ".." so every file has one cache key
+static std::string normalizePath(std::string path)
+{
+    std::replace(path.begin(), path.end(), '\\', '/');
+    bool absolute = !path.empty() && path[0] == '/';
+    std::vector<std::string> parts;
+    std::stringstream stream(path);
+    std::string part;
+    while (std::getline(stream, part, '/'))
+    {
+        if (part.empty() || part == ".")
+            continue;
+        if (part == ".." && !parts.empty() && parts.back() != "..")
+            parts.pop_back();
+        else
+            parts.push_back(part);
+    }
+    std::string result = absolute ? "/" : "";
+    for (size_t i = 0; i < parts.size(); ++i)
+    {
+        result += (i == 0 ? "" : "/") + parts[i];
+    }
+    return result;
+}
+
+static std::string directoryOf(const std::string& path)
+{
+    size_t slash = path.find_last_of('/');
+    return (slash == std::string::npos) ? "" : path.substr(0, slash + 1);
+}
+
+static bool isIdentifierStart(char c)
+{
+    return std::isalpha((unsigned char)c) || c == '_';
+}
+
+static bool isIdentifierChar(char c)
+{
+    return std::isalnum((unsigned char)c) || c == '_';
+}
+
+static void appendIdentifiers(const std::string& text, std::vector<std::string>& identifiers)
+{
+    for (size_t i = 0; i < text.size();)
+    {
+        if (isIdentifierStart(text[i]))
+        {
+            size_t start = i;
+            while (i < text.size() && isIdentifierChar(text[i]))
+                ++i;
+            identifiers.push_back(text.substr(start, i - start));
+        }
+        else
+        {
+            ++i;
+        }
+    }
+}
+
+ShaderPreprocessor::ShaderPreprocessor(bool stripUnusedFunctions_in)
+    :
+    stripUnusedFunctions(stripUnusedFunctions_in)
+{
+}
+
+bool ShaderPreprocessor::process(const std::string& path, std::string& source)
+{
+    sourceNames.clear();
+    files.clear();
+    includeStack.clear();
+    source.clear();
+
+    if (!collect(normalizePath(path), "", 0))
+    {
+        return false;
+    }
+    findReachableFunctions();
+    emitted.assign(files.size(), false);
+    emit(*files[0], source);
+    return true;
+}
+
+void ShaderPreprocessor::setDefines(const std::vector<std::string>& defines_in)
+{
+    defines = defines_in;
+}
+
+std::string ShaderPreprocessor::remapLog(const std::string& log) const
+{
+    //Mesa/AMD: "0:12(3): error" or "ERROR: 0:12: ...", NVIDIA: "0(12) : error"
+    static const std::regex location("^((?:ERROR|WARNING): )?(\\d+)([:(])(\\d+)");
+    std::stringstream stream(log);
+    std::string line;
+    std::string result;
+    while (std::getline(stream, line))
+    {
+        std::smatch match;
+        if (std::regex_search(line, match, location))
+        {
+            size_t index = std::stoul(match[2].str());
+            if (index < sourceNames.size())
+            {
+                line = match[1].str() + sourceNames[index] + match[3].str() + match[4].str() + match.suffix().str();
+            }
+        }
+        result += line + "\n";
+    }
+    return result;
+}
+
+const std::vector<std::string>& ShaderPreprocessor::getSourceNames() const
+{
+    return sourceNames;
+}
+
+void ShaderPreprocessor::clearCache()
+{
+    cache.clear();
+}
+
+ShaderPreprocessor::SourceFilePtr ShaderPreprocessor::load(const std::string& path)
+{
+    auto cached = cache.find(path);
+    if (cached != cache.end())
+    {
+        return cached->second;
+    }
+
+    std::ifstream stream(path, std::ios::binary);
+    if (!stream)
+    {
+        return nullptr;
+    }
+    std::stringstream contents;
+    contents << stream.rdbuf();
+
+    std::shared_ptr<SourceFile> file = std::make_shared<SourceFile>();
+    file->path = path;
+    file->text = contents.str();
+    //hg_sdf.glsl comes with Windows line endings
+    file->text.erase(std::remove(file->text.begin(), file->text.end(), '\r'), file->text.end());
+    scan(*file);
+
+    cache[path] = file;
+    return file;
+}
+
+/*
+    Finds the directives, the function definitions and the identifiers each of them refers to.
+
+    This is no GLSL parser, it only tracks braces and parentheses: a "(...)" at global scope that is
+    followed by "{" opens a function body, named by the identifier before the "(".
+*/
+void ShaderPreprocessor::scan(SourceFile& file)
+{
+    const std::string& text = file.text;
+    int line = 0;
+    size_t lineBegin = 0;
+    bool atLineStart = true;
+
+    int braceDepth = 0;
+    int parenDepth = 0;
+    bool afterParameters = false;
+    int currentFunction = -1;
+
+    //Identifiers of the global statement being read, they belong to a function header if a body follows
+    std::vector<std::string> statement;
+    std::string lastIdentifier;
+    size_t lastIdentifierLine = 0;
+    size_t typeIdentifierLine = 0;
+    std::string candidateName;
+    size_t candidateBegin = 0;
+
+    auto identifiers = [&]() -> std::vector<std::string>&
+    {
+        return (currentFunction >= 0) ? file.functions[currentFunction].identifiers : file.globalIdentifiers;
+    };
+
+    size_t i = 0;
+    while (i < text.size())
+    {
+        char c = text[i];
+        char next = (i + 1 < text.size()) ? text[i + 1] : '\0';
+
+        if (c == '\n')
+        {
+            ++line;
+            lineBegin = ++i;
+            atLineStart = true;
+            continue;
+        }
+        if (std::isspace((unsigned char)c))
+        {
+            ++i;
+            continue;
+        }
+        //Comments
+        if (c == '/' && next == '/')
+        {
+            i = text.find('\n', i);
+            if (i == std::string::npos)
+                i = text.size();
+            continue;
+        }
+        if (c == '/' && next == '*')
+        {
+            size_t end = text.find("*/", i + 2);
+            end = (end == std::string::npos) ? text.size() : end + 2;
+            for (size_t k = i; k < end; ++k)
+            {
+                if (text[k] == '\n')
+                {
+                    ++line;
+                    lineBegin = k + 1;
+                }
+            }
+            i = end;
+            continue;
+        }
+        //Preprocessor directives
+        if (atLineStart && c == '#')
+        {
+            size_t end = text.find('\n', i);
+            if (end == std::string::npos)
+                end = text.size();
+            std::string directive = text.substr(i + 1, end - i - 1);
+            std::stringstream words(directive);
+            std::string word;
+            words >> word;
+            if (word == "include")
+            {
+                size_t open = directive.find('"');
+                size_t close = directive.find('"', open + 1);
+                if (open != std::string::npos && close != std::string::npos)
+                {
+                    std::string include = directive.substr(open + 1, close - open - 1);
+                    file.directives.push_back({ line, normalizePath(directoryOf(file.path) + include) });
+                }
+            }
+            else if (word == "pragma" && (words >> word) && word == "once")
+            {
+                file.once = true;
+                file.directives.push_back({ line, "" });
+            }
+            else
+            {
+                appendIdentifiers(directive, identifiers());
+            }
+            i = end;
+            continue;
+        }
+        atLineStart = false;
+
+        if (isIdentifierStart(c))
+        {
+            size_t start = i;
+            while (i < text.size() && isIdentifierChar(text[i]))
+                ++i;
+            std::string identifier = text.substr(start, i - start);
+            if (currentFunction >= 0 || braceDepth > 0)
+            {
+                identifiers().push_back(identifier);
+            }
+            else
+            {
+                statement.push_back(identifier);
+                if (parenDepth == 0)
+                {
+                    typeIdentifierLine = lastIdentifierLine;
+                    lastIdentifier = identifier;
+                    lastIdentifierLine = lineBegin;
+                    afterParameters = false;
+                }
+            }
+            continue;
+        }
+        //Numbers, including suffixes and exponents
+        if (std::isdigit((unsigned char)c) || (c == '.' && std::isdigit((unsigned char)next)))
+        {
+            while (i < text.size() && (isIdentifierChar(text[i]) || text[i] == '.' ||
+                   ((text[i] == '+' || text[i] == '-') && (text[i - 1] == 'e' || text[i - 1] == 'E'))))
+                ++i;
+            afterParameters = false;
+            continue;
+        }
+
+        bool parametersClosed = false;
+        switch (c)
+        {
+            case '(':
+                if (braceDepth == 0)
+                {
+                    if (parenDepth == 0)
+                    {
+                        candidateName = lastIdentifier;
+                        candidateBegin = typeIdentifierLine;
+                    }
+                    ++parenDepth;
+                }
+                break;
+            case ')':
+                if (braceDepth == 0 && parenDepth > 0)
+                {
+                    --parenDepth;
+                    parametersClosed = (parenDepth == 0);
+                }
+                break;
+            case '{':
+                if (braceDepth == 0)
+                {
+                    if (afterParameters)
+                    {
+                        file.functions.push_back({ candidateName, candidateBegin, text.size(), {} });
+                        currentFunction = (int)file.functions.size() - 1;
+                    }
+                    else
+                    {
+                        file.globalIdentifiers.insert(file.globalIdentifiers.end(), statement.begin(), statement.end());
+                    }
+                    statement.clear();
+                }
+                ++braceDepth;
+                break;
+            case '}':
+                braceDepth = std::max(braceDepth - 1, 0);
+                if (braceDepth == 0 && currentFunction >= 0)
+                {
+                    file.functions[currentFunction].end = i + 1;
+                    currentFunction = -1;
+                }
+                break;
+            case ';':
+                if (braceDepth == 0 && parenDepth == 0)
+                {
+                    file.globalIdentifiers.insert(file.globalIdentifiers.end(), statement.begin(), statement.end());
+                    statement.clear();
+                }
+                break;
+            default:
+                break;
+        }
+        afterParameters = parametersClosed;
+        ++i;
+    }
+    file.globalIdentifiers.insert(file.globalIdentifiers.end(), statement.begin(), statement.end());
+}
+
+bool ShaderPreprocessor::collect(const std::string& path, const std::string& includedFrom, int includeLine)
+{
+    if (std::find(includeStack.begin(), includeStack.end(), path) != includeStack.end())
+    {
+        std::cout << "ERROR::SHADER::RECURSIVE_INCLUDE->" << path << " included from " << includedFrom << ":" << includeLine << std::endl;
+        return false;
+    }
+
+    SourceFilePtr file = load(path);
+    if (!file)
+    {
+        std::cout << "ERROR::SHADER::FILE_NOT_SUCCESSFULLY_READ->" << path;
+        if (!includedFrom.empty())
+        {
+            std::cout << " included from " << includedFrom << ":" << includeLine;
+        }
+        std::cout << std::endl;
+        return false;
+    }
+
+    bool known = std::find(sourceNames.begin(), sourceNames.end(), path) != sourceNames.end();
+    if (known && file->once)
+    {
+        return true;
+    }
+    if (!known)
+    {
+        files.push_back(file);
+        sourceNames.push_back(path);
+    }
+
+    bool success = true;
+    includeStack.push_back(path);
+    for (const Directive& directive : file->directives)
+    {
+        if (!directive.include.empty())
+        {
+            success = collect(directive.include, path, directive.line + 1) && success;
+        }
+    }
+    includeStack.pop_back();
+    return success;
+}
+
+/*
+    Everything the main file mentions and every global declaration is a root. A function of an
+    included file is kept if its name is reachable from a root, overloads are kept together.
+*/
+void ShaderPreprocessor::findReachableFunctions()
+{
+    keepFunction.assign(files.size(), std::vector<bool>());
+    for (size_t i = 0; i < files.size(); ++i)
+    {
+        keepFunction[i].assign(files[i]->functions.size(), !stripUnusedFunctions || i == 0);
+    }
+    if (!stripUnusedFunctions)
+    {
+        return;
+    }
+
+    std::unordered_map<std::string, std::vector<std::pair<size_t, size_t>>> definitions;
+    std::vector<std::string> pending;
+    for (size_t i = 0; i < files.size(); ++i)
+    {
+        const SourceFile& file = *files[i];
+        pending.insert(pending.end(), file.globalIdentifiers.begin(), file.globalIdentifiers.end());
+        for (size_t j = 0; j < file.functions.size(); ++j)
+        {
+            if (i == 0)
+                pending.insert(pending.end(), file.functions[j].identifiers.begin(), file.functions[j].identifiers.end());
+            else
+                definitions[file.functions[j].name].push_back({ i, j });
+        }
+    }
+
+    std::unordered_set<std::string> visited;
+    while (!pending.empty())
+    {
+        std::string name = pending.back();
+        pending.pop_back();
+        if (!visited.insert(name).second)
+            continue;
+
+        auto found = definitions.find(name);
+        if (found == definitions.end())
+            continue;
+        for (const std::pair<size_t, size_t>& definition : found->second)
+        {
+            const Function& function = files[definition.first]->functions[definition.second];
+            keepFunction[definition.first][definition.second] = true;
+            pending.insert(pending.end(), function.identifiers.begin(), function.identifiers.end());
+        }
+    }
+}
+
+void ShaderPreprocessor::emit(const SourceFile& file, std::string& source)
+{
+    size_t index = std::find(sourceNames.begin(), sourceNames.end(), file.path) - sourceNames.begin();
+    emitted[index] = true;
+
+    //Blank unused functions but keep their newlines so line numbers stay valid
+    std::string text = file.text;
+    for (size_t j = 0; j < file.functions.size(); ++j)
+    {
+        if (keepFunction[index][j])
+            continue;
+        for (size_t k = file.functions[j].begin; k < file.functions[j].end; ++k)
+        {
+            if (text[k] != '\n')
+                text[k] = ' ';
+        }
+    }
+
+    std::stringstream stream(text);
+    std::string line;
+    int lineIndex = 0;
+    auto directive = file.directives.begin();
+    while (std::getline(stream, line))
+    {
+        if (directive != file.directives.end() && directive->line == lineIndex)
+        {
+            if (!directive->include.empty())
+            {
+                size_t child = std::find(sourceNames.begin(), sourceNames.end(), directive->include) - sourceNames.begin();
+                if (files[child]->once && emitted[child])
+                {
+                    source += "\n";
+                }
+                else
+                {
+                    //In GLSL 3.30+ "#line n" numbers the following line n
+                    source += "#line 1 " + std::to_string(child) + "\n";
+                    emit(*files[child], source);
+                    source += "#line " + std::to_string(lineIndex + 2) + " " + std::to_string(index) + "\n";
+                }
+            }
+            else
+            {
+                //#pragma once
+                source += "\n";
+            }
+            ++directive;
+        }
+        else
+        {
+            //Trailing blanks of stripped functions
+            line.erase(line.find_last_not_of(' ') + 1);
+            source += line + "\n";
+            //Nothing but comments may precede #version
+            if (index == 0 && !defines.empty() && line.compare(0, 8, "#version") == 0)
+            {
+                for (const std::string& define : defines)
+                    source += "#define " + define + "\n";
+                source += "#line " + std::to_string(lineIndex + 2) + " 0\n";
+            }
+        }
+        ++lineIndex;
+    }
+}
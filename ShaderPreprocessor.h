@@ -0,0 +1,94 @@
+#pragma once
+#ifndef SHADER_PREPROCESSOR_H
+#define SHADER_PREPROCESSOR_H
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <unordered_map>
+
+
+/*
+    Resolves #include "file" directives in GLSL sources before they are handed to the driver.
+
+    - Paths are relative to the including file. A file containing "#pragma once" is inserted only
+      once per stage.
+    - Every inserted file gets its own source string number through #line directives.
+      remapLog turns the numbers in driver messages back into file names.
+    - Files are read and scanned once per process, every shader including hg_sdf shares the cache.
+    - Functions of included files that the stage never calls are blanked out (line numbers stay
+      intact), so a scene only compiles the parts of hg_sdf it uses.
+    - Defines given to setDefines are inserted right after the #version line of the root file,
+      e.g. to build several programs from one source.
+*/
+class ShaderPreprocessor
+{
+public:
+    ShaderPreprocessor(bool stripUnusedFunctions_in = true);
+
+    //Expands path into source. Returns false if the file or one of its includes could not be read.
+    bool process(const std::string& path, std::string& source);
+    //"NAME" or "NAME VALUE" for every #define, used by the next process calls
+    void setDefines(const std::vector<std::string>& defines_in);
+    //Replaces source string numbers in a compile log ("0:12(3)" or "0(12)") with file names
+    std::string remapLog(const std::string& log) const;
+    //Source string number -> path, valid after process
+    const std::vector<std::string>& getSourceNames() const;
+
+    //Forget the files read so far, e.g. to pick up edited shaders
+    static void clearCache();
+
+private:
+    struct Function
+    {
+        std::string name;
+        //Character range of the definition, begin is at the start of a line
+        size_t begin;
+        size_t end;
+        //Identifiers in the body
+        std::vector<std::string> identifiers;
+    };
+
+    struct Directive
+    {
+        //0 based
+        int line;
+        //Normalized path of an #include, empty for #pragma once
+        std::string include;
+    };
+
+    struct SourceFile
+    {
+        std::string path;
+        std::string text;
+        bool once = false;
+        std::vector<Directive> directives;
+        std::vector<Function> functions;
+        //Identifiers outside of function definitions
+        std::vector<std::string> globalIdentifiers;
+    };
+
+    using SourceFilePtr = std::shared_ptr<const SourceFile>;
+
+    static SourceFilePtr load(const std::string& path);
+    static void scan(SourceFile& file);
+    bool collect(const std::string& path, const std::string& includedFrom, int includeLine);
+    void findReachableFunctions();
+    void emit(const SourceFile& file, std::string& source);
+
+private:
+    bool stripUnusedFunctions;
+    std::vector<std::string> defines;
+    std::vector<std::string> sourceNames;
+
+    //State of the current process call
+    std::vector<SourceFilePtr> files;
+    std::vector<std::string> includeStack;
+    //Per file, per function
+    std::vector<std::vector<bool>> keepFunction;
+    std::vector<bool> emitted;
+
+    static std::unordered_map<std::string, SourceFilePtr> cache;
+};
+
+#endif
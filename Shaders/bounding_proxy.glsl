@@ -0,0 +1,25 @@
+#pragma once
+/*
+    Bounding proxies, shared by the scenes. A bound is the distance to a cheap volume that encloses an
+    expensive object of closest_object, so it never exceeds the distance to the object itself.
+    The object only has to be evaluated if its bound is closer than the union so far (res), otherwise it
+    cannot win the union and skipping it leaves the distance exact.
+    With proxies the object is also skipped while its bound is further than PROXY_MARGIN, fOpUnionProxyID
+    then unites the bound in its place: a shorter but safe step that cannot be a hit. Only the primary
+    march takes these steps, the soft shadows and the ambient occlusion weigh the distances themselves.
+*/
+
+//Distance to a bound below which its object is evaluated by the primary march
+const float PROXY_MARGIN = 2.0;
+
+//Whether the object behind bound has to be evaluated. Pass proxies as a constant, each caller compiles its own branch.
+bool proxy_needed(bool proxies, vec2 res, float bound)
+{
+    return bound < (proxies ? min(res.x, PROXY_MARGIN) : res.x);
+}
+
+//Union of res (distance, id) with an object that proxy_needed skipped, at the distance of its bound
+vec2 fOpUnionProxyID(vec2 res, float bound, float id)
+{
+    return (bound < res.x) ? vec2(bound, id) : res;
+}
@@ -0,0 +1,47 @@
+#pragma once
+//Checkerboard rendering of the single pass shaders, shared by the scenes. See Checkerboard.h for the host side.
+
+/*
+    0: every pixel is marched. Otherwise only the pixels with (x + y) % 2 == checkerboard_field - 1 are,
+    packed side by side into a target of half the width, so every fragment of a quad marches a pixel.
+*/
+uniform int checkerboard_field = 0;
+
+//Hit distance of the primary ray, stored by render() of the scene for the reconstruction
+float primary_distance = 0.0;
+
+//Center of the full resolution pixel the fragment marches
+vec2 checkerboard_pixel(vec2 frag_coord)
+{
+    if(checkerboard_field == 0)
+    {
+        return frag_coord;
+    }
+    int y = int(frag_coord.y);
+    int x = 2 * int(frag_coord.x) + ((y + checkerboard_field - 1) & 1);
+    return vec2(x, y) + 0.5;
+}
+
+/*
+    Implicitly filtered texture lookup. Neighbouring fragments of the field target are two pixels apart
+    horizontally and one pixel diagonally apart vertically (the rows alternate their offset), which would
+    pick a blurrier mip level than the full resolution image. The gradients are rebuilt for single pixel steps.
+*/
+vec4 checkerboard_texture(sampler2D tex, vec2 uv)
+{
+    if(checkerboard_field == 0)
+    {
+        return texture(tex, uv);
+    }
+    vec2 dx = 0.5 * dFdx(uv);
+    //The second row of a 2x2 quad is shifted right of the first one in field 1 and left in field 2
+    float shift = (checkerboard_field == 1) ? 1.0 : -1.0;
+    vec2 dy = dFdy(uv) - shift * dx;
+    return textureGrad(tex, uv, dx, dy);
+}
+
+//The field target keeps the hit distance in alpha, the window gets an opaque image
+float checkerboard_alpha()
+{
+    return (checkerboard_field != 0) ? primary_distance : 1.0;
+}
@@ -0,0 +1,104 @@
+#version 410 core
+/*
+    Checkerboard reconstruction. See Checkerboard.h for the host side.
+
+    The scene marched half of the pixels into the field texture (color and hit distance, packed to half
+    the width). Those are copied, every other pixel is reprojected into last frame's reconstructed image
+    with the closest hit of its four marched neighbours. The history is used if the surface it saw
+    projects back into this pixel and is clamped to the colors of the neighbours, otherwise the pixel is
+    filled from the neighbour pair with the smaller color difference, which follows edges instead of
+    blurring them.
+*/
+
+in vec2 uv;
+
+layout(location = 0) out vec4 FragColor;
+
+#include "../frame_constants.glsl"
+//This frame's field and last frame's reconstructed image, both keep the hit distance in alpha
+uniform sampler2D field_texture;
+uniform sampler2D history_texture;
+//1 or 2: the marched pixels have (x + y) % 2 == checkerboard_field - 1
+uniform int checkerboard_field = 1;
+//0: there is no usable history, every missing pixel is filled from its neighbours
+uniform int checkerboard_history = 0;
+
+//Distance in pixels the history's surface may land from this pixel
+const float REPROJECTION_TOLERANCE = 1.0;
+//Share of the neighbours' color range the history may lie outside of it
+const float CLAMP_MARGIN = 0.5;
+
+
+//Marched sample of a full resolution pixel of this frame's field, clamped to the image
+vec4 field_sample(ivec2 pixel)
+{
+    ivec2 texel = clamp(ivec2(pixel.x >> 1, pixel.y), ivec2(0), textureSize(field_texture, 0) - 1);
+    return texelFetch(field_texture, texel, 0);
+}
+
+//Pixel coordinates of p in this frame, the inverse of the jittered primary rays
+vec2 current_pixel(vec3 p)
+{
+    vec3 v = p - camera_pos;
+    vec2 aspect_ratio = vec2(resolution.x / resolution.y, 1.0);
+    vec2 plane = vec2(dot(v, right), dot(v, up)) / dot(v, front);
+    return (plane / aspect_ratio + 0.5) * resolution - jitter;
+}
+
+//Point last frame's ray through the texel hit at distance t
+vec3 previous_point(ivec2 texel, float t)
+{
+    vec2 aspect_ratio = vec2(resolution.x / resolution.y, 1.0);
+    vec2 plane = aspect_ratio * ((vec2(texel) + 0.5 + previous_jitter) / resolution - 0.5);
+    return previous_camera_pos + t * normalize(plane.x * previous_right + plane.y * previous_up + previous_front);
+}
+
+void main()
+{
+    ivec2 texel = ivec2(gl_FragCoord.xy);
+    if(((texel.x + texel.y) & 1) == checkerboard_field - 1)
+    {
+        FragColor = field_sample(texel);
+        return;
+    }
+
+    vec4 west = field_sample(texel - ivec2(1, 0));
+    vec4 east = field_sample(texel + ivec2(1, 0));
+    vec4 south = field_sample(texel - ivec2(0, 1));
+    vec4 north = field_sample(texel + ivec2(0, 1));
+    bool horizontal = length(west.rgb - east.rgb) < length(south.rgb - north.rgb);
+    vec4 fill = horizontal ? 0.5 * (west + east) : 0.5 * (south + north);
+    if(checkerboard_history == 0)
+    {
+        FragColor = fill;
+        return;
+    }
+
+    //The closest neighbouring hit, so silhouettes move with the foreground
+    float t = min(min(west.a, east.a), min(south.a, north.a));
+    vec2 aspect_ratio = vec2(resolution.x / resolution.y, 1.0);
+    mat3 lookAt = mat3(right, up, -front);
+    vec3 rd = lookAt * normalize(vec3(aspect_ratio * ((gl_FragCoord.xy + jitter) / resolution - 0.5), -1.0));
+    vec2 previous = previous_pixel(camera_pos + t * rd) - previous_jitter;
+    if(any(lessThan(previous, vec2(0.0))) || any(greaterThanEqual(previous, resolution)))
+    {
+        FragColor = fill;
+        return;
+    }
+
+    //Whatever covered that spot last frame has to be what this pixel sees now (no disocclusion)
+    ivec2 source = ivec2(previous);
+    vec3 seen = previous_point(source, texelFetch(history_texture, source, 0).a);
+    if(dot(seen - camera_pos, front) <= 0.0 || length(current_pixel(seen) - gl_FragCoord.xy) > REPROJECTION_TOLERANCE)
+    {
+        FragColor = fill;
+        return;
+    }
+    //Four neighbours miss texture detail that lies between them, the range is widened by CLAMP_MARGIN of itself
+    vec3 low = min(min(west.rgb, east.rgb), min(south.rgb, north.rgb));
+    vec3 high = max(max(west.rgb, east.rgb), max(south.rgb, north.rgb));
+    vec3 margin = CLAMP_MARGIN * (high - low);
+    //Filtered, the nearest texel would resample the history by up to half a pixel every frame
+    vec3 history = texture(history_texture, previous / resolution).rgb;
+    FragColor = vec4(clamp(history, low - margin, high + margin), length(seen - camera_pos));
+}
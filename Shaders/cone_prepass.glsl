@@ -0,0 +1,54 @@
+#pragma once
+//Hierarchical cone marching prepass, shared by the scenes. See ConePrepass.h for the host side.
+
+//> 0: this draw is a prepass level, every fragment marches the cone of a tile this many pixels wide
+uniform int cone_level_tile = 0;
+//> 0: cone_start_texture holds safe start distances of tiles this many pixels wide
+uniform int cone_start_tile = 0;
+uniform sampler2D cone_start_texture;
+
+//Defined by the scene
+vec2 closest_object(vec3 p);
+
+//Distance every ray through the full resolution pixel can skip
+float cone_start_distance(vec2 pixel)
+{
+    if(cone_start_tile <= 0)
+    {
+        return 0.0;
+    }
+    return texelFetch(cone_start_texture, ivec2(pixel) / cone_start_tile, 0).r;
+}
+
+/*
+    Marches the cone around rd with the given half angle tangent.
+    A sphere of radius d around the axis point at t contains the cone section up to t + d - t * cone_tan,
+    so that is a safe step for every ray inside the cone. Stops once the cone touches a surface.
+*/
+float cone_march(vec3 ro, vec3 rd, float start, float cone_tan, float max_dist, int max_steps)
+{
+    float t = start;
+    for(int i = 0; i < max_steps; ++i)
+    {
+        float radius = t * cone_tan;
+        float dist = closest_object(ro + t * rd).x;
+        if(dist <= radius || t > max_dist)
+        {
+            break;
+        }
+        t += dist - radius;
+    }
+    return t;
+}
+
+//Start distance of the tile of this prepass fragment, the direction is built like in main() of the scenes
+float cone_prepass(vec3 ro, mat3 lookAt, vec2 aspect_ratio, float max_dist, int max_steps)
+{
+    float tile = float(cone_level_tile);
+    vec2 pixel = floor(gl_FragCoord.xy) * tile;
+    vec2 center = (pixel + 0.5 * tile) / resolution;
+    vec3 rd = lookAt * normalize(vec3(aspect_ratio * (center - 0.5), -1.0));
+    //Half diagonal of the tile on the image plane at distance 1 bounds the angle to every pixel ray of the tile
+    float cone_tan = 0.7072 * tile / resolution.y;
+    return cone_march(ro, rd, cone_start_distance(pixel), cone_tan, max_dist, max_steps);
+}
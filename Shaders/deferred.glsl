@@ -0,0 +1,123 @@
+#pragma once
+/*
+    Deferred pipeline, shared by the scenes. See DeferredPipeline.h for the host side.
+
+    The scene fragment shader is built once per stage with one of these defined:
+    DEFERRED_GBUFFER (march and normal), DEFERRED_SHADOW, DEFERRED_AO and DEFERRED_SHADE.
+    Without any of them the scene renders in a single pass.
+*/
+
+//x: distance along the primary ray (> MAX_DIST for the background), y: material ID, zw: octahedral normal
+uniform sampler2D gbuffer_texture;
+uniform sampler2D shadow_texture;
+uniform sampler2D ao_texture;
+//Full resolution pixels per texel side of the shadow and AO targets (1, 2 or 4)
+uniform int lighting_scale = 1;
+
+struct GBufferSample
+{
+    vec2 object;
+    vec3 normal;
+};
+
+vec2 oct_wrap(vec2 v)
+{
+    return (1.0 - abs(v.yx)) * vec2(v.x >= 0.0 ? 1.0 : -1.0, v.y >= 0.0 ? 1.0 : -1.0);
+}
+
+//Unit vector -> [-1, 1]^2, the octahedron folded onto the plane
+vec2 encode_normal(vec3 n)
+{
+    n /= abs(n.x) + abs(n.y) + abs(n.z);
+    return (n.z >= 0.0) ? n.xy : oct_wrap(n.xy);
+}
+
+vec3 decode_normal(vec2 e)
+{
+    vec3 n = vec3(e, 1.0 - abs(e.x) - abs(e.y));
+    if(n.z < 0.0)
+    {
+        n.xy = oct_wrap(n.xy);
+    }
+    return normalize(n);
+}
+
+vec4 encode_gbuffer(vec2 object, vec3 normal)
+{
+    return vec4(object, encode_normal(normal));
+}
+
+GBufferSample read_gbuffer(vec2 pixel)
+{
+    vec4 texel = texelFetch(gbuffer_texture, ivec2(pixel), 0);
+    return GBufferSample(texel.xy, decode_normal(texel.zw));
+}
+
+//Direction of the primary ray through a (jittered) pixel center, main() of the scenes builds its ray with it as well
+vec3 pixel_ray(mat3 lookAt, vec2 aspect_ratio, vec2 pixel)
+{
+    return lookAt * normalize(vec3(aspect_ratio * ((pixel + jitter) / resolution - 0.5), -1.0));
+}
+
+//Center of the full resolution pixel whose G-buffer sample a texel of the shadow and AO targets traces from
+vec2 lighting_source_pixel(ivec2 texel)
+{
+    //Blocks cut by the right and top border use their last pixel
+    return min(vec2(texel * lighting_scale + lighting_scale / 2), resolution - 1.0) + 0.5;
+}
+
+/*
+    Joint bilateral upsampling of a shadow or AO target.
+    The 2x2 texels around the pixel are weighted bilinearly and by how close the depth and normal of
+    their source samples are to the pixel's own, so the terms do not bleed across silhouettes and creases.
+    If every neighbour lies on another surface the one with the closest depth is used.
+*/
+float upsample_lighting(sampler2D lighting, vec2 pixel, GBufferSample center)
+{
+    if(lighting_scale == 1)
+    {
+        return texelFetch(lighting, ivec2(pixel), 0).r;
+    }
+
+    //Texel coordinates in which source pixels are at integers
+    vec2 position = (pixel - float(lighting_scale / 2) - 0.5) / float(lighting_scale);
+    ivec2 base = ivec2(floor(position));
+    vec2 f = position - floor(position);
+    ivec2 last = textureSize(lighting, 0) - 1;
+    float sum = 0.0;
+    float weight_sum = 0.0;
+    float closest = 0.0;
+    float closest_depth = 1e30;
+    for(int i = 0; i < 4; ++i)
+    {
+        ivec2 offset = ivec2(i & 1, i >> 1);
+        ivec2 texel = clamp(base + offset, ivec2(0), last);
+        GBufferSample source = read_gbuffer(lighting_source_pixel(texel));
+        float value = texelFetch(lighting, texel, 0).r;
+
+        vec2 bilinear = mix(1.0 - f, f, vec2(offset));
+        float depth_difference = abs(source.object.x - center.object.x);
+        float depth_weight = exp(-depth_difference / (0.01 * center.object.x + 0.01));
+        float normal_weight = pow(max(dot(source.normal, center.normal), 0.0), 16.0);
+        float weight = bilinear.x * bilinear.y * depth_weight * normal_weight;
+        sum += weight * value;
+        weight_sum += weight;
+
+        if(depth_difference < closest_depth)
+        {
+            closest_depth = depth_difference;
+            closest = value;
+        }
+    }
+    return (weight_sum > 1e-4) ? sum / weight_sum : closest;
+}
+
+float read_shadow(vec2 pixel, GBufferSample center)
+{
+    return upsample_lighting(shadow_texture, pixel, center);
+}
+
+float read_ao(vec2 pixel, GBufferSample center)
+{
+    return upsample_lighting(ao_texture, pixel, center);
+}
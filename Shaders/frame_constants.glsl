@@ -0,0 +1,35 @@
+#pragma once
+//Per frame values shared by every scene program, filled by FrameConstantsBuffer (FrameConstants.h)
+//Members of an unnamed block are accessed by their plain names
+layout(std140) uniform FrameConstants
+{
+    vec3 camera_pos;
+    float time;
+    vec3 front;
+    vec3 right;
+    vec3 up;
+    vec2 resolution;
+    //Subpixel offset of the primary rays in pixels
+    vec2 jitter;
+    //Camera of the previous frame, used to reproject last frame's results
+    vec3 previous_camera_pos;
+    vec3 previous_front;
+    vec3 previous_right;
+    vec3 previous_up;
+    vec2 previous_jitter;
+};
+
+//Pixel coordinates of p in the previous frame (without its jitter), x is negative if p was behind the previous camera
+vec2 previous_pixel(vec3 p)
+{
+    vec3 v = p - previous_camera_pos;
+    float z = dot(v, previous_front);
+    if(z <= 0.0)
+    {
+        return vec2(-1.0);
+    }
+    //Inverse of the direction built from uv in main() of the scenes
+    vec2 aspect_ratio = vec2(resolution.x / resolution.y, 1.0);
+    vec2 plane = vec2(dot(v, previous_right), dot(v, previous_up)) / z;
+    return (plane / aspect_ratio + 0.5) * resolution;
+}
@@ -0,0 +1,82 @@
+#pragma once
+//Min/max heightmap pyramid of a heightfield scene. See Heightmap.h for the host side.
+
+//> 0: this draw bakes level 0 of a heightmap this many texels wide, every fragment is one texel
+uniform int heightmap_bake = 0;
+//Levels of heightmap_texture, 0 if the scene has no baked heightmap
+uniform int heightmap_levels = 0;
+//Width of a level 0 texel in world units, the map is centered on the origin of the xz plane
+uniform float heightmap_texel = 16.0;
+/*
+    r, g: min and max height of the ground over the texel
+    b: flags of the scene
+    a: upper bound of every surface above the texel, the tracer only reads this one
+    Each level holds the min of r and the max of the others over the 2x2 texels below.
+*/
+uniform sampler2D heightmap_texture;
+
+const int HEIGHTMAP_STEPS = 128;
+
+//Defined by the scene: the texel of the square of the xz plane from corner to corner + size
+vec4 heightmap_bake_texel(vec2 corner, float size);
+
+//Level 0 texel of this bake fragment
+vec4 heightmap_bake_fragment()
+{
+    vec2 corner = (floor(gl_FragCoord.xy) - 0.5 * float(heightmap_bake)) * heightmap_texel;
+    return heightmap_bake_texel(corner, heightmap_texel);
+}
+
+/*
+    Maximum mipmap tracing: walks the pyramid from the coarse levels down, skipping every cell the ray
+    passes above the bound of. A cell the ray dips under is refined into its level below from where the
+    ray reaches the bound, after a cell is left the walk continues one level up.
+    Returns the distance where the ray first dips under the bound of a level 0 texel, where it leaves
+    the map or, if it only rises over the map, beyond max_dist. start is returned without a heightmap.
+*/
+float heightmap_trace(vec3 ro, vec3 rd, float start, float max_dist)
+{
+    if(heightmap_levels <= 0)
+    {
+        return start;
+    }
+    int top = heightmap_levels - 1;
+    int size = textureSize(heightmap_texture, 0).x;
+    //The ray in level 0 texels
+    vec2 origin = ro.xz / heightmap_texel + 0.5 * float(size);
+    vec2 direction = rd.xz / heightmap_texel;
+    vec2 inverse = vec2(direction.x < 0.0 ? -1.0 : 1.0, direction.y < 0.0 ? -1.0 : 1.0) / max(abs(direction), vec2(1e-12));
+    vec2 ahead = step(0.0, direction);
+
+    float t = start;
+    int level = top;
+    for(int i = 0; i < HEIGHTMAP_STEPS && t <= max_dist; ++i)
+    {
+        float cell_size = exp2(float(level));
+        ivec2 cell = ivec2(floor((origin + t * direction) / cell_size));
+        if(any(lessThan(cell, ivec2(0))) || any(greaterThanEqual(cell, ivec2(size >> level))))
+        {
+            break;
+        }
+        float bound = texelFetch(heightmap_texture, cell, level).a;
+        vec2 exits = ((vec2(cell) + ahead) * cell_size - origin) * inverse;
+        float t_exit = min(exits.x, exits.y);
+        if(min(ro.y + t * rd.y, ro.y + t_exit * rd.y) > bound)
+        {
+            //Just past the border, into the next cell
+            t = t_exit * 1.00001 + 0.001;
+            level = min(level + 1, top);
+            continue;
+        }
+        if(ro.y + t * rd.y > bound)
+        {
+            t = (bound - ro.y) / rd.y;
+        }
+        if(level == 0)
+        {
+            break;
+        }
+        --level;
+    }
+    return t;
+}
@@ -0,0 +1,26 @@
+#version 410 core
+/*
+    Builds one level of the min/max heightmap pyramid (Shaders/heightmap.glsl) from the level below.
+    See Heightmap.h for the host side.
+*/
+
+in vec2 uv;
+
+layout(location = 0) out vec4 FragColor;
+
+uniform sampler2D heightmap_texture;
+//Level the texels are reduced from
+uniform int heightmap_level = 0;
+
+
+void main()
+{
+    ivec2 texel = 2 * ivec2(gl_FragCoord.xy);
+    vec4 a = texelFetch(heightmap_texture, texel, heightmap_level);
+    vec4 b = texelFetch(heightmap_texture, texel + ivec2(1, 0), heightmap_level);
+    vec4 c = texelFetch(heightmap_texture, texel + ivec2(0, 1), heightmap_level);
+    vec4 d = texelFetch(heightmap_texture, texel + ivec2(1, 1), heightmap_level);
+    vec4 lower = min(min(a, b), min(c, d));
+    vec4 upper = max(max(a, b), max(c, d));
+    FragColor = vec4(lower.r, upper.gba);
+}
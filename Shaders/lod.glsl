@@ -0,0 +1,20 @@
+#pragma once
+//Distance based level of detail of procedural noise, shared by the scenes. Needs frame_constants.glsl.
+
+//Pixels per footprint the noise octaves are filtered at, 0 evaluates every octave in full. Set per scene by the host.
+uniform float lod_bias = 1.0;
+
+//Width of the pixel cone (1 / resolution.y per unit of distance) at p in world units, times lod_bias
+float pixel_footprint(vec3 p)
+{
+    return lod_bias * distance(p, camera_pos) / resolution.y;
+}
+
+/*
+    Weight of a noise octave of the given frequency seen through the footprint. The octave fades out
+    between 4 and 2 footprints per period and is gone once the footprint passes the Nyquist limit.
+*/
+float octave_weight(float frequency, float footprint)
+{
+    return 1.0 - smoothstep(0.25, 0.5, footprint * frequency);
+}
@@ -0,0 +1,60 @@
+#pragma once
+//Surface normal estimators, shared by the scenes. The host picks one per scene with normal_estimator.
+
+const int NORMAL_CENTRAL = 0;
+const int NORMAL_TETRAHEDRAL = 1;
+const int NORMAL_FORWARD = 2;
+const int NORMAL_ANALYTIC = 3;
+
+/*
+    0: central differences, 6 distance evaluations
+    1: tetrahedral differences, 4 evaluations at the corners of a tetrahedron around the point
+    2: forward differences, 3 evaluations plus the sample ray_march stopped at
+    3: analytic gradient of the scene (scene_gradient), tetrahedral where it has none
+*/
+uniform int normal_estimator = NORMAL_TETRAHEDRAL;
+
+//Point and distance bound where ray_march of the scene stopped, the forward differences reuse it
+vec4 primary_hit_sample = vec4(vec3(1e30), 0.0);
+
+//Defined by the scene
+vec2 closest_object(vec3 p);
+#ifdef SCENE_GRADIENT
+//Gradient of the distance field at p on the object id, false if it has no closed form there
+bool scene_gradient(vec3 p, float id, out vec3 gradient);
+#endif
+
+/*
+    Normal at p on the object id, differences are taken over h.
+    Only the direction is returned, so the tetrahedral sum and the forward differences skip the division by h.
+*/
+vec3 estimate_normal(vec3 p, float id, float h)
+{
+#ifdef SCENE_GRADIENT
+    vec3 gradient;
+    if(normal_estimator == NORMAL_ANALYTIC && scene_gradient(p, id, gradient))
+    {
+        return normalize(gradient);
+    }
+#endif
+    if(normal_estimator == NORMAL_CENTRAL)
+    {
+        return normalize(vec3(
+                              closest_object(vec3(p.x + h, p.y, p.z)).x - closest_object(vec3(p.x - h, p.y, p.z)).x,
+                              closest_object(vec3(p.x, p.y + h, p.z)).x - closest_object(vec3(p.x, p.y - h, p.z)).x,
+                              closest_object(vec3(p.x, p.y, p.z + h)).x - closest_object(vec3(p.x, p.y, p.z - h)).x));
+    }
+    if(normal_estimator == NORMAL_FORWARD)
+    {
+        float center = (primary_hit_sample.xyz == p) ? primary_hit_sample.w : closest_object(p).x;
+        return normalize(vec3(
+                              closest_object(vec3(p.x + h, p.y, p.z)).x - center,
+                              closest_object(vec3(p.x, p.y + h, p.z)).x - center,
+                              closest_object(vec3(p.x, p.y, p.z + h)).x - center));
+    }
+    vec2 k = vec2(1.0, -1.0);
+    return normalize(k.xyy * closest_object(p + k.xyy * h).x +
+                     k.yyx * closest_object(p + k.yyx * h).x +
+                     k.yxy * closest_object(p + k.yxy * h).x +
+                     k.xxx * closest_object(p + k.xxx * h).x);
+}
@@ -0,0 +1,42 @@
+#pragma once
+//March step diagnostics, shared by the scenes. See StepStatistics.h for the host side.
+
+//0: shaded image, 1: primary ray steps, 2: shadow ray steps, 3: ambient occlusion taps, 4: all of them
+uniform int debug_mode;
+
+//Counted by ray_march, get_soft_shadow and get_ambient_occlusion of the scene
+int primary_steps = 0;
+int shadow_steps = 0;
+int ao_steps = 0;
+//Set by the loops that ran out of budget before they converged, the counts alone cannot tell
+bool primary_exhausted = false;
+bool shadow_exhausted = false;
+
+//Raw counts for the histogram readback, only stored if a second color attachment is bound.
+//w holds the exhausted flags, 1 for the primary ray and 2 for the shadow ray
+layout(location = 1) out vec4 StepCounts;
+
+//Blue (cheap) -> green -> yellow -> red (budget spent)
+vec3 step_heatmap(float t)
+{
+    t = clamp(t, 0.0, 1.0);
+    vec3 cold = mix(vec3(0.0, 0.0, 0.5), vec3(0.0, 0.8, 0.4), smoothstep(0.0, 0.33, t));
+    vec3 warm = mix(vec3(1.0, 0.9, 0.0), vec3(1.0, 0.0, 0.0), smoothstep(0.66, 1.0, t));
+    return mix(cold, warm, smoothstep(0.33, 0.66, t));
+}
+
+//Stores the counts and replaces color with the heatmap of the selected counter in a debug mode
+vec3 apply_step_debug(vec3 color, int max_steps)
+{
+    StepCounts = vec4(primary_steps, shadow_steps, ao_steps, (primary_exhausted ? 1.0 : 0.0) + (shadow_exhausted ? 2.0 : 0.0));
+
+    if(debug_mode == 1)
+        return step_heatmap(float(primary_steps) / float(max_steps));
+    if(debug_mode == 2)
+        return step_heatmap(float(shadow_steps) / float(max_steps));
+    if(debug_mode == 3)
+        return step_heatmap(float(ao_steps) / 8.0);
+    if(debug_mode == 4)
+        return step_heatmap(float(primary_steps + shadow_steps + ao_steps) / float(2 * max_steps + 8));
+    return color;
+}
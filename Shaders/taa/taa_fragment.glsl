@@ -0,0 +1,65 @@
+#version 410 core
+/*
+    Temporal anti-aliasing resolve. See TemporalAA.h for the host side.
+
+    The scene renders with a different subpixel jitter every frame. Each pixel blends its new sample
+    into the resolved image of the last frame, found by reprojecting the pixel's G-buffer hit with the
+    previous camera. The history is clamped to the colors of the 3x3 neighbourhood of the new frame,
+    which rejects what was disoccluded or changed since.
+*/
+
+in vec2 uv;
+
+layout(location = 0) out vec4 FragColor;
+
+#include "../frame_constants.glsl"
+#include "../deferred.glsl"
+//This frame's jittered image and last frame's resolved one
+uniform sampler2D current_texture;
+uniform sampler2D resolved_texture;
+//0: there is no usable history, the new frame is passed through
+uniform int taa_history = 0;
+//Weight of the new frame in the blend
+uniform float taa_blend = 0.1;
+
+
+void main()
+{
+    ivec2 texel = ivec2(gl_FragCoord.xy);
+    ivec2 last = ivec2(resolution) - 1;
+    vec3 col = texelFetch(current_texture, texel, 0).rgb;
+
+    //Color bounds of the neighbourhood and the closest hit, so silhouettes move with the foreground
+    vec3 low = col;
+    vec3 high = col;
+    float t = read_gbuffer(gl_FragCoord.xy).object.x;
+    for(int i = 0; i < 9; ++i)
+    {
+        ivec2 neighbour = clamp(texel + ivec2(i % 3, i / 3) - 1, ivec2(0), last);
+        vec3 c = texelFetch(current_texture, neighbour, 0).rgb;
+        low = min(low, c);
+        high = max(high, c);
+        t = min(t, texelFetch(gbuffer_texture, neighbour, 0).x);
+    }
+
+    if(taa_history == 0)
+    {
+        FragColor = vec4(col, 1.0);
+        return;
+    }
+
+    //Velocity from the camera movement: where the hit of the pixel center was seen last frame
+    vec2 aspect_ratio = vec2(resolution.x / resolution.y, 1.0);
+    mat3 lookAt = mat3(right, up, -front);
+    vec3 rd = lookAt * normalize(vec3(aspect_ratio * (uv - 0.5), -1.0));
+    vec2 previous = previous_pixel(camera_pos + t * rd);
+    if(any(lessThan(previous, vec2(0.0))) || any(greaterThanEqual(previous, resolution)))
+    {
+        FragColor = vec4(col, 1.0);
+        return;
+    }
+
+    vec3 history = texture(resolved_texture, previous / resolution).rgb;
+    history = clamp(history, low, high);
+    FragColor = vec4(mix(history, col, taa_blend), 1.0);
+}
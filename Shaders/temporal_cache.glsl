@@ -0,0 +1,102 @@
+#pragma once
+//Temporal reprojection of the primary hit distances, shared by the scenes. See DeferredPipeline.h for the host side.
+
+//1: history_texture holds last frame's G-buffer, rendered from the previous camera of the frame constants
+uniform int temporal_history = 0;
+uniform sampler2D history_texture;
+
+//Share of the reprojected distance the march starts in front of it
+const float TEMPORAL_MARGIN = 0.02;
+//Largest reprojection search radius in pixels, faster camera movement marches from the safe start
+const int TEMPORAL_MAX_RADIUS = 3;
+
+//Defined by the scene
+vec2 closest_object(vec3 p);
+
+//Point last frame's (jittered) primary ray through the given pixel hit, w is 0 if it hit the background
+vec4 previous_hit(ivec2 texel, float max_dist)
+{
+    float t = texelFetch(history_texture, texel, 0).x;
+    vec2 aspect_ratio = vec2(resolution.x / resolution.y, 1.0);
+    vec2 plane = aspect_ratio * ((vec2(texel) + 0.5 + previous_jitter) / resolution - 0.5);
+    vec3 rd = normalize(plane.x * previous_right + plane.y * previous_up + previous_front);
+    return vec4(previous_camera_pos + t * rd, (t < max_dist) ? 1.0 : 0.0);
+}
+
+/*
+    Distance the primary ray of the pixel can start at, found from last frame's hits.
+    safe is a distance known to be free already (cone prepass start or the camera's distance bound).
+
+    The current hit is guessed from last frame's distance of the same pixel and projected into the
+    previous image twice, each time taking the distance along rd of the surface seen there.
+    Anything that covers this ray now in front of that surface lies beyond safe, so the camera
+    movement across the ray shifted it by at most |movement| / safe image heights against the surface
+    (a camera flying along its view direction barely shifts anything near the center). The start is
+    the closest of the previous hits within that radius, minus TEMPORAL_MARGIN.
+
+    0.0 (no better start) is returned when there is no history, the radius is larger than
+    TEMPORAL_MAX_RADIUS, the position is not inside the previous image (newly revealed at a border),
+    the surface seen there does not lie on this ray (disocclusion) or the start point is inside the
+    scene (animated geometry moved towards the camera). Animated geometry moving sideways faster than
+    the margin is not detected.
+*/
+float temporal_start_distance(vec3 ro, vec3 rd, vec2 pixel, float safe, float max_dist)
+{
+    if(temporal_history == 0)
+    {
+        return 0.0;
+    }
+    //Only movement across the ray shifts surfaces at different depths against each other
+    vec3 movement = ro - previous_camera_pos;
+    vec3 across = movement - dot(movement, rd) * rd;
+    int radius = int(ceil(length(across) * resolution.y / max(safe, 1e-4))) + 1;
+    if(radius > TEMPORAL_MAX_RADIUS)
+    {
+        return 0.0;
+    }
+
+    float t = texelFetch(history_texture, ivec2(pixel), 0).x;
+    vec2 source = pixel;
+    for(int i = 0; i < 2; ++i)
+    {
+        //The previous rays went through the jittered pixel centers
+        source = previous_pixel(ro + min(t, max_dist) * rd) - previous_jitter;
+        if(any(lessThan(source, vec2(radius))) || any(greaterThanEqual(source, resolution - float(radius))))
+        {
+            return 0.0;
+        }
+        vec4 hit = previous_hit(ivec2(source), max_dist);
+        t = (hit.w > 0.0) ? dot(hit.xyz - ro, rd) : max_dist;
+    }
+
+    //The surface seen at the final position has to be within a few pixel footprints of this ray
+    vec4 center = previous_hit(ivec2(source), max_dist);
+    if(center.w > 0.0)
+    {
+        float along = dot(center.xyz - ro, rd);
+        float footprint = 4.0 * along / resolution.y;
+        if(along <= 0.0 || length(center.xyz - (ro + along * rd)) > footprint)
+        {
+            return 0.0;
+        }
+    }
+
+    float closest = max_dist;
+    for(int y = -radius; y <= radius; ++y)
+    {
+        for(int x = -radius; x <= radius; ++x)
+        {
+            vec4 hit = previous_hit(ivec2(source) + ivec2(x, y), max_dist);
+            if(hit.w > 0.0)
+            {
+                closest = min(closest, dot(hit.xyz - ro, rd));
+            }
+        }
+    }
+    float start = closest * (1.0 - TEMPORAL_MARGIN);
+    if(start <= safe || closest_object(ro + start * rd).x <= 0.0)
+    {
+        return 0.0;
+    }
+    return start;
+}
@@ -0,0 +1,247 @@
+#pragma once
+#ifndef SIMD_LANES_H
+#define SIMD_LANES_H
+
+#include <cmath>
+#include <algorithm>
+
+#if defined(__AVX2__) || defined(__AVX512F__)
+#include <immintrin.h>
+#endif
+
+/*
+    Float lanes for the packet ray marcher.
+ 
+    Float8 wraps AVX2 (8 x 32-bit), Float16 wraps AVX-512 (16 x 32-bit). Without those instruction
+    sets (compile with -mavx2 / -mavx512f or -march=native) Float8 falls back to a plain array the
+    compiler can still auto-vectorize. FloatN/MaskN name the widest type the build supports.
+ 
+    All types share one interface: arithmetic operators, comparisons returning a mask, mask logic
+    with any()/none(), select(mask, a, b) in place of branches and the math functions hg_sdf.h
+    needs, so the templated SDF code runs on them unchanged.
+*/
+namespace simd
+{
+#if defined(__AVX2__)
+
+    struct Mask8
+    {
+        __m256 v;
+    };
+
+    struct Float8
+    {
+        static constexpr int WIDTH = 8;
+        using Mask = Mask8;
+        __m256 v;
+
+        Float8() : v(_mm256_setzero_ps()) {}
+        Float8(float s) : v(_mm256_set1_ps(s)) {}
+        Float8(__m256 v_in) : v(v_in) {}
+
+        static Float8 load(const float* p) { return _mm256_loadu_ps(p); }
+        void store(float* p) const { _mm256_storeu_ps(p, v); }
+    };
+
+    inline Float8 operator+(Float8 a, Float8 b) { return _mm256_add_ps(a.v, b.v); }
+    inline Float8 operator-(Float8 a, Float8 b) { return _mm256_sub_ps(a.v, b.v); }
+    inline Float8 operator*(Float8 a, Float8 b) { return _mm256_mul_ps(a.v, b.v); }
+    inline Float8 operator/(Float8 a, Float8 b) { return _mm256_div_ps(a.v, b.v); }
+    inline Float8 operator-(Float8 a) { return _mm256_xor_ps(a.v, _mm256_set1_ps(-0.0f)); }
+
+    inline Mask8 operator<(Float8 a, Float8 b) { return { _mm256_cmp_ps(a.v, b.v, _CMP_LT_OQ) }; }
+    inline Mask8 operator<=(Float8 a, Float8 b) { return { _mm256_cmp_ps(a.v, b.v, _CMP_LE_OQ) }; }
+    inline Mask8 operator>(Float8 a, Float8 b) { return { _mm256_cmp_ps(a.v, b.v, _CMP_GT_OQ) }; }
+    inline Mask8 operator>=(Float8 a, Float8 b) { return { _mm256_cmp_ps(a.v, b.v, _CMP_GE_OQ) }; }
+    inline Mask8 operator==(Float8 a, Float8 b) { return { _mm256_cmp_ps(a.v, b.v, _CMP_EQ_OQ) }; }
+
+    inline Mask8 operator&(Mask8 a, Mask8 b) { return { _mm256_and_ps(a.v, b.v) }; }
+    inline Mask8 operator|(Mask8 a, Mask8 b) { return { _mm256_or_ps(a.v, b.v) }; }
+    inline Mask8 operator~(Mask8 a) { return { _mm256_xor_ps(a.v, _mm256_castsi256_ps(_mm256_set1_epi32(-1))) }; }
+    inline int bits(Mask8 m) { return _mm256_movemask_ps(m.v); }
+
+    inline Float8 min(Float8 a, Float8 b) { return _mm256_min_ps(a.v, b.v); }
+    inline Float8 max(Float8 a, Float8 b) { return _mm256_max_ps(a.v, b.v); }
+    inline Float8 abs(Float8 a) { return _mm256_andnot_ps(_mm256_set1_ps(-0.0f), a.v); }
+    inline Float8 sqrt(Float8 a) { return _mm256_sqrt_ps(a.v); }
+    inline Float8 floor(Float8 a) { return _mm256_floor_ps(a.v); }
+    //mask ? a : b
+    inline Float8 select(Mask8 m, Float8 a, Float8 b) { return _mm256_blendv_ps(b.v, a.v, m.v); }
+
+#else
+
+    //Portable fallback, one bit per lane
+    struct Mask8
+    {
+        int v;
+    };
+
+    struct Float8
+    {
+        static constexpr int WIDTH = 8;
+        using Mask = Mask8;
+        float v[8];
+
+        Float8() { std::fill(v, v + 8, 0.0f); }
+        Float8(float s) { std::fill(v, v + 8, s); }
+
+        static Float8 load(const float* p) { Float8 r; std::copy(p, p + 8, r.v); return r; }
+        void store(float* p) const { std::copy(v, v + 8, p); }
+    };
+
+    template<typename Op>
+    inline Float8 lanewise(Float8 a, Float8 b, Op op)
+    {
+        Float8 r;
+        for (int i = 0; i < 8; ++i) r.v[i] = op(a.v[i], b.v[i]);
+        return r;
+    }
+
+    template<typename Op>
+    inline Mask8 compare(Float8 a, Float8 b, Op op)
+    {
+        int m = 0;
+        for (int i = 0; i < 8; ++i) m |= op(a.v[i], b.v[i]) ? (1 << i) : 0;
+        return { m };
+    }
+
+    inline Float8 operator+(Float8 a, Float8 b) { return lanewise(a, b, [](float x, float y) { return x + y; }); }
+    inline Float8 operator-(Float8 a, Float8 b) { return lanewise(a, b, [](float x, float y) { return x - y; }); }
+    inline Float8 operator*(Float8 a, Float8 b) { return lanewise(a, b, [](float x, float y) { return x * y; }); }
+    inline Float8 operator/(Float8 a, Float8 b) { return lanewise(a, b, [](float x, float y) { return x / y; }); }
+    inline Float8 operator-(Float8 a) { return lanewise(a, a, [](float x, float) { return -x; }); }
+
+    inline Mask8 operator<(Float8 a, Float8 b) { return compare(a, b, [](float x, float y) { return x < y; }); }
+    inline Mask8 operator<=(Float8 a, Float8 b) { return compare(a, b, [](float x, float y) { return x <= y; }); }
+    inline Mask8 operator>(Float8 a, Float8 b) { return compare(a, b, [](float x, float y) { return x > y; }); }
+    inline Mask8 operator>=(Float8 a, Float8 b) { return compare(a, b, [](float x, float y) { return x >= y; }); }
+    inline Mask8 operator==(Float8 a, Float8 b) { return compare(a, b, [](float x, float y) { return x == y; }); }
+
+    inline Mask8 operator&(Mask8 a, Mask8 b) { return { a.v & b.v }; }
+    inline Mask8 operator|(Mask8 a, Mask8 b) { return { a.v | b.v }; }
+    inline Mask8 operator~(Mask8 a) { return { ~a.v & 0xFF }; }
+    inline int bits(Mask8 m) { return m.v; }
+
+    inline Float8 min(Float8 a, Float8 b) { return lanewise(a, b, [](float x, float y) { return std::min(x, y); }); }
+    inline Float8 max(Float8 a, Float8 b) { return lanewise(a, b, [](float x, float y) { return std::max(x, y); }); }
+    inline Float8 abs(Float8 a) { return lanewise(a, a, [](float x, float) { return std::abs(x); }); }
+    inline Float8 sqrt(Float8 a) { return lanewise(a, a, [](float x, float) { return std::sqrt(x); }); }
+    inline Float8 floor(Float8 a) { return lanewise(a, a, [](float x, float) { return std::floor(x); }); }
+    inline Float8 select(Mask8 m, Float8 a, Float8 b)
+    {
+        Float8 r;
+        for (int i = 0; i < 8; ++i) r.v[i] = (m.v >> i & 1) ? a.v[i] : b.v[i];
+        return r;
+    }
+
+#endif
+
+#if defined(__AVX512F__)
+
+    struct Mask16
+    {
+        __mmask16 v;
+    };
+
+    struct Float16
+    {
+        static constexpr int WIDTH = 16;
+        using Mask = Mask16;
+        __m512 v;
+
+        Float16() : v(_mm512_setzero_ps()) {}
+        Float16(float s) : v(_mm512_set1_ps(s)) {}
+        Float16(__m512 v_in) : v(v_in) {}
+
+        static Float16 load(const float* p) { return _mm512_loadu_ps(p); }
+        void store(float* p) const { _mm512_storeu_ps(p, v); }
+    };
+
+    inline Float16 operator+(Float16 a, Float16 b) { return _mm512_add_ps(a.v, b.v); }
+    inline Float16 operator-(Float16 a, Float16 b) { return _mm512_sub_ps(a.v, b.v); }
+    inline Float16 operator*(Float16 a, Float16 b) { return _mm512_mul_ps(a.v, b.v); }
+    inline Float16 operator/(Float16 a, Float16 b) { return _mm512_div_ps(a.v, b.v); }
+    inline Float16 operator-(Float16 a) { return _mm512_sub_ps(_mm512_setzero_ps(), a.v); }
+
+    inline Mask16 operator<(Float16 a, Float16 b) { return { _mm512_cmp_ps_mask(a.v, b.v, _CMP_LT_OQ) }; }
+    inline Mask16 operator<=(Float16 a, Float16 b) { return { _mm512_cmp_ps_mask(a.v, b.v, _CMP_LE_OQ) }; }
+    inline Mask16 operator>(Float16 a, Float16 b) { return { _mm512_cmp_ps_mask(a.v, b.v, _CMP_GT_OQ) }; }
+    inline Mask16 operator>=(Float16 a, Float16 b) { return { _mm512_cmp_ps_mask(a.v, b.v, _CMP_GE_OQ) }; }
+    inline Mask16 operator==(Float16 a, Float16 b) { return { _mm512_cmp_ps_mask(a.v, b.v, _CMP_EQ_OQ) }; }
+
+    inline Mask16 operator&(Mask16 a, Mask16 b) { return { (__mmask16)(a.v & b.v) }; }
+    inline Mask16 operator|(Mask16 a, Mask16 b) { return { (__mmask16)(a.v | b.v) }; }
+    inline Mask16 operator~(Mask16 a) { return { (__mmask16)~a.v }; }
+    inline int bits(Mask16 m) { return m.v; }
+
+    inline Float16 min(Float16 a, Float16 b) { return _mm512_min_ps(a.v, b.v); }
+    inline Float16 max(Float16 a, Float16 b) { return _mm512_max_ps(a.v, b.v); }
+    inline Float16 abs(Float16 a) { return _mm512_abs_ps(a.v); }
+    inline Float16 sqrt(Float16 a) { return _mm512_sqrt_ps(a.v); }
+    inline Float16 floor(Float16 a) { return _mm512_mask_roundscale_ps(a.v, 0xFFFF, a.v, _MM_FROUND_TO_NEG_INF | _MM_FROUND_NO_EXC); }
+    inline Float16 select(Mask16 m, Float16 a, Float16 b) { return _mm512_mask_blend_ps(m.v, b.v, a.v); }
+
+    using FloatN = Float16;
+#else
+    using FloatN = Float8;
+#endif
+    using MaskN = FloatN::Mask;
+
+
+    /*
+        Width independent helpers
+    */
+
+    template<typename M>
+    inline bool any(M m) { return bits(m) != 0; }
+
+    template<typename M>
+    inline bool none(M m) { return bits(m) == 0; }
+
+    template<typename L>
+    inline L& operator+=(L& a, L b) { return a = a + b; }
+
+    template<typename L>
+    inline L& operator-=(L& a, L b) { return a = a - b; }
+
+    template<typename L>
+    inline L& operator*=(L& a, L b) { return a = a * b; }
+
+    //Applies a scalar function lane by lane, for transcendentals that are rare enough not to need a vector version
+    template<typename L, typename F>
+    inline L map(L x, F f)
+    {
+        alignas(64) float v[L::WIDTH];
+        x.store(v);
+        for (int i = 0; i < L::WIDTH; ++i) v[i] = f(v[i]);
+        return L::load(v);
+    }
+
+    template<typename L>
+    inline L sin(L x) { return map(x, [](float a) { return std::sin(a); }); }
+
+    template<typename L>
+    inline L cos(L x) { return map(x, [](float a) { return std::cos(a); }); }
+
+    template<typename L>
+    inline L atan2(L y, L x)
+    {
+        alignas(64) float vy[L::WIDTH], vx[L::WIDTH];
+        y.store(vy);
+        x.store(vx);
+        for (int i = 0; i < L::WIDTH; ++i) vy[i] = std::atan2(vy[i], vx[i]);
+        return L::load(vy);
+    }
+
+    template<typename L>
+    inline L pow(L x, L e)
+    {
+        alignas(64) float vx[L::WIDTH], ve[L::WIDTH];
+        x.store(vx);
+        e.store(ve);
+        for (int i = 0; i < L::WIDTH; ++i) vx[i] = std::pow(vx[i], ve[i]);
+        return L::load(vx);
+    }
+}
+
+#endif
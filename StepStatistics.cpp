@@ -0,0 +1,130 @@
+#include "StepStatistics.h"
+
+#include <fstream>
+#include <iomanip>
+#include <algorithm>
+#include <cmath>
+
+StepStatistics::StepStatistics(int maxSteps_in)
+    :
+    maxSteps(maxSteps_in),
+    pixelCount(0)
+{
+    clear();
+}
+
+void StepStatistics::clear()
+{
+    for (int counter = 0; counter < COUNTER_COUNT; ++counter)
+    {
+        histograms[counter].assign(maxSteps + 1, 0);
+        exhaustedCounts[counter] = 0;
+    }
+    pixelCount = 0;
+}
+
+void StepStatistics::accumulate(const float* pixels, int width, int height)
+{
+    size_t count = (size_t)width * height;
+    for (size_t i = 0; i < count; ++i)
+    {
+        const float* pixel = pixels + i * 4;
+        for (int counter = 0; counter < COUNTER_COUNT; ++counter)
+        {
+            int steps = std::min(std::max((int)std::lround(pixel[counter]), 0), maxSteps);
+            ++histograms[counter][steps];
+        }
+        //Bit 0: the primary ray ran out of steps, bit 1: the shadow ray
+        int exhausted = (int)std::lround(pixel[3]);
+        exhaustedCounts[PRIMARY] += exhausted & 1;
+        exhaustedCounts[SHADOW] += (exhausted >> 1) & 1;
+    }
+    pixelCount += count;
+}
+
+StepStatistics::Summary StepStatistics::summarize(Counter counter) const
+{
+    Summary summary = { 0.0, 0, 0, 0, 0, 0.0 };
+    if (pixelCount == 0)
+        return summary;
+
+    const std::vector<uint64_t>& histogram = histograms[counter];
+    auto percentile = [&](double p)
+    {
+        uint64_t rank = std::max<uint64_t>((uint64_t)std::ceil(p * pixelCount), 1);
+        uint64_t seen = 0;
+        for (int steps = 0; steps <= maxSteps; ++steps)
+        {
+            seen += histogram[steps];
+            if (seen >= rank)
+                return steps;
+        }
+        return maxSteps;
+    };
+
+    double total = 0.0;
+    for (int steps = 0; steps <= maxSteps; ++steps)
+    {
+        total += (double)steps * histogram[steps];
+        if (histogram[steps] > 0)
+            summary.max = steps;
+    }
+    summary.mean = total / pixelCount;
+    summary.p50 = percentile(0.50);
+    summary.p95 = percentile(0.95);
+    summary.p99 = percentile(0.99);
+    summary.exhausted = (double)exhaustedCounts[counter] / pixelCount;
+    return summary;
+}
+
+uint64_t StepStatistics::getPixelCount() const
+{
+    return pixelCount;
+}
+
+void StepStatistics::print(std::ostream& out, const std::string& title) const
+{
+    out << "Step counts of " << title << " (" << pixelCount << " pixels)\n";
+    out << std::fixed << std::setprecision(2);
+    for (int counter = 0; counter < COUNTER_COUNT; ++counter)
+    {
+        Summary summary = summarize((Counter)counter);
+        out << "  " << std::setw(8) << std::left << counterName((Counter)counter) << std::right
+            << " mean " << std::setw(7) << summary.mean << " p50 " << std::setw(4) << summary.p50
+            << " p95 " << std::setw(4) << summary.p95 << " p99 " << std::setw(4) << summary.p99
+            << " max " << std::setw(4) << summary.max;
+        if (counter != AMBIENT_OCCLUSION)
+            out << " exhausted " << summary.exhausted * 100.0 << "%";
+        out << "\n";
+    }
+    out << std::defaultfloat << std::flush;
+}
+
+bool StepStatistics::writeCSV(const std::string& path) const
+{
+    std::ofstream file(path);
+    if (!file)
+    {
+        std::cout << "ERROR::STEP_STATISTICS::FILE_NOT_SUCCESSFULLY_OPENED->" << path << std::endl;
+        return false;
+    }
+
+    file << "steps," << counterName(PRIMARY) << "," << counterName(SHADOW) << "," << counterName(AMBIENT_OCCLUSION) << "\n";
+    for (int steps = 0; steps <= maxSteps; ++steps)
+    {
+        file << steps << "," << histograms[PRIMARY][steps] << "," << histograms[SHADOW][steps] << ","
+             << histograms[AMBIENT_OCCLUSION][steps] << "\n";
+    }
+    return (bool)file;
+}
+
+const char* StepStatistics::counterName(Counter counter)
+{
+    switch (counter)
+    {
+        case PRIMARY: return "primary";
+        case SHADOW: return "shadow";
+        case AMBIENT_OCCLUSION: return "ao";
+        default: return "";
+    }
+}
@@ -0,0 +1,63 @@
+#pragma once
+#ifndef STEP_STATISTICS_H
+#define STEP_STATISTICS_H
+
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <iostream>
+
+
+/*
+    Histograms of the march step counts the scene shaders write to their second color
+    attachment (StepCounts in Shaders/step_debug.glsl): primary ray steps, shadow ray steps and
+    ambient occlusion taps per pixel.
+
+    A primary or shadow ray whose march loop ran out of budget before it converged sets its flag in
+    the fourth channel, the share of those pixels is reported as "exhausted". A count may span more
+    than one loop (the heightfield march hands rays over to ray_march), counts above maxSteps land in
+    the last bin.
+*/
+class StepStatistics
+{
+public:
+    enum Counter
+    {
+        PRIMARY,
+        SHADOW,
+        AMBIENT_OCCLUSION,
+        COUNTER_COUNT
+    };
+
+    struct Summary
+    {
+        double mean;
+        int p50;
+        int p95;
+        int p99;
+        int max;
+        //Share of the pixels whose march ran out of steps
+        double exhausted;
+    };
+
+    StepStatistics(int maxSteps_in = 256);
+    void clear();
+    //pixels: RGBA floats, one counter per channel and the exhausted flags in alpha
+    void accumulate(const float* pixels, int width, int height);
+
+    Summary summarize(Counter counter) const;
+    uint64_t getPixelCount() const;
+    void print(std::ostream& out, const std::string& title) const;
+    //One row per step count with the number of pixels of every counter
+    bool writeCSV(const std::string& path) const;
+
+    static const char* counterName(Counter counter);
+
+private:
+    int maxSteps;
+    std::vector<uint64_t> histograms[COUNTER_COUNT];
+    uint64_t exhaustedCounts[COUNTER_COUNT];
+    uint64_t pixelCount;
+};
+
+#endif
@@ -0,0 +1,117 @@
+#include "TemporalAA.h"
+#include "FrameConstants.h"
+
+TemporalAA::TemporalAA()
+    :
+    current(0),
+    hasHistory(false),
+    frameIndex(0),
+    width(0),
+    height(0)
+{
+}
+
+void TemporalAA::create(int width_in, int height_in)
+{
+    if (!resolveShader.isValid())
+    {
+        resolveShader = Shader("Shaders/taa/taa_vertex.glsl", "Shaders/taa/taa_fragment.glsl");
+        resolveShader.bindUniformBlock(FrameConstantsBuffer::BLOCK_NAME, FrameConstantsBuffer::BINDING);
+        resolveShader.use();
+        resolveShader.uniform<int>("gbuffer_texture").set(DeferredPipeline::GBUFFER_UNIT);
+        resolveShader.uniform<int>("current_texture").set(CURRENT_UNIT);
+        resolveShader.uniform<int>("resolved_texture").set(RESOLVED_UNIT);
+        resolveShader.uniform<float>("taa_blend").set(BLEND);
+        historyUniform = resolveShader.uniform<int>("taa_history");
+    }
+
+    sceneTarget.release();
+    for (Framebuffer& target : resolved)
+        target.release();
+    width = width_in;
+    height = height_in;
+    sceneTarget = Framebuffer(width, height, {GL_RGBA16F}, false);
+    for (Framebuffer& target : resolved)
+        target = Framebuffer(width, height, {GL_RGBA16F}, false);
+    resetHistory();
+}
+
+void TemporalAA::resize(int width_in, int height_in)
+{
+    if (width_in == width && height_in == height)
+        return;
+    create(width_in, height_in);
+}
+
+glm::vec2 TemporalAA::getJitter() const
+{
+    //Skips index 0, which is 0 in every base
+    int index = frameIndex % SEQUENCE_LENGTH + 1;
+    return glm::vec2(halton(index, 2), halton(index, 3)) - 0.5f;
+}
+
+const Framebuffer& TemporalAA::getSceneTarget() const
+{
+    return sceneTarget;
+}
+
+void TemporalAA::resolve(GLuint quad, const Framebuffer* target, GpuProfiler& profiler)
+{
+    current = 1 - current;
+    {
+        GpuProfiler::Scope pass(profiler, "taa");
+        glActiveTexture(GL_TEXTURE0 + CURRENT_UNIT);
+        glBindTexture(GL_TEXTURE_2D, sceneTarget.getColorTexture());
+        glActiveTexture(GL_TEXTURE0 + RESOLVED_UNIT);
+        glBindTexture(GL_TEXTURE_2D, resolved[1 - current].getColorTexture());
+        resolveShader.use();
+        historyUniform.set(hasHistory ? 1 : 0);
+        resolved[current].bind();
+        glBindVertexArray(quad);
+        glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0);
+    }
+    hasHistory = true;
+    ++frameIndex;
+
+    //The resolved image stays as the history, the caller gets a copy
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, resolved[current].getID());
+    glBindFramebuffer(GL_DRAW_FRAMEBUFFER, target ? target->getID() : 0);
+    glBlitFramebuffer(0, 0, width, height, 0, 0, width, height, GL_COLOR_BUFFER_BIT, GL_NEAREST);
+    glBindFramebuffer(GL_FRAMEBUFFER, target ? target->getID() : 0);
+}
+
+void TemporalAA::resetHistory()
+{
+    hasHistory = false;
+}
+
+void TemporalAA::release()
+{
+    sceneTarget.release();
+    for (Framebuffer& target : resolved)
+        target.release();
+    resetHistory();
+}
+
+int TemporalAA::getWidth() const
+{
+    return width;
+}
+
+int TemporalAA::getHeight() const
+{
+    return height;
+}
+
+float TemporalAA::halton(int index, int base)
+{
+    float result = 0.0f;
+    float fraction = 1.0f;
+    while (index > 0)
+    {
+        fraction /= base;
+        result += fraction * (index % base);
+        index /= base;
+    }
+    return result;
+}
@@ -0,0 +1,68 @@
+#pragma once
+#ifndef TEMPORAL_AA_H
+#define TEMPORAL_AA_H
+
+#include <GL/glew.h>
+#include <glm/glm.hpp>
+
+#include "Shader.h"
+#include "Framebuffer.h"
+#include "DeferredPipeline.h"
+#include "GpuProfiler.h"
+
+
+/*
+    Temporal anti-aliasing of the deferred pipeline (Shaders/taa/taa_fragment.glsl).
+
+    Every frame shifts the primary rays by the next offset of a Halton (2, 3) sequence (getJitter,
+    written to the frame constants) and the scene is shaded into getSceneTarget(). resolve() blends that
+    frame into the reprojected history and copies the result to the caller's render target, so over
+    SEQUENCE_LENGTH frames each pixel gathers as many subpixel samples for the cost of one.
+
+    The reprojection reads the G-buffer hit distances, the pipeline's targets have to be bound still.
+    Like Framebuffer, it is a light handle around GL names. Call release() to free them.
+*/
+class TemporalAA
+{
+public:
+    static constexpr int SEQUENCE_LENGTH = 8;
+    //Texture units of the new frame and the history, above the deferred pipeline units
+    static constexpr int CURRENT_UNIT = DeferredPipeline::HISTORY_UNIT + 1;
+    static constexpr int RESOLVED_UNIT = DeferredPipeline::HISTORY_UNIT + 2;
+    //Weight of the new frame, the history keeps the rest
+    static constexpr float BLEND = 0.1f;
+
+    TemporalAA();
+    //Builds the resolve program if needed and allocates the targets, needs a current context
+    void create(int width_in, int height_in);
+    void resize(int width_in, int height_in);
+    //Subpixel offset of the rays of the next frame in pixels, within [-0.5, 0.5]
+    glm::vec2 getJitter() const;
+    //The scene is shaded into this target instead of the caller's one
+    const Framebuffer& getSceneTarget() const;
+    //Resolves the frame into target (the window if it is null) and moves on to the next jitter offset
+    void resolve(GLuint quad, const Framebuffer* target, GpuProfiler& profiler);
+    //The next frame is passed through without history
+    void resetHistory();
+    void release();
+
+    int getWidth() const;
+    int getHeight() const;
+
+private:
+    static float halton(int index, int base);
+
+private:
+    Shader resolveShader;
+    Uniform<int> historyUniform;
+    Framebuffer sceneTarget;
+    //The resolved image of this frame and of the last one
+    Framebuffer resolved[2];
+    int current;
+    bool hasHistory;
+    int frameIndex;
+    int width;
+    int height;
+};
+
+#endif
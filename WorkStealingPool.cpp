@@ -0,0 +1,131 @@
+#include "WorkStealingPool.h"
+
+WorkStealingPool::WorkStealingPool(int threadCount)
+    :
+    job(nullptr),
+    generation(0),
+    activeWorkers(0),
+    remaining(0),
+    stopping(false)
+{
+    if (threadCount <= 0)
+        threadCount = std::max(1u, std::thread::hardware_concurrency());
+
+    for (int i = 0; i < threadCount; ++i)
+    {
+        queues.emplace_back(new Queue());
+    }
+    for (int i = 0; i < threadCount; ++i)
+    {
+        threads.emplace_back(&WorkStealingPool::workerLoop, this, i);
+    }
+}
+
+WorkStealingPool::~WorkStealingPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    wakeWorkers.notify_all();
+    for (std::thread& thread : threads)
+    {
+        thread.join();
+    }
+}
+
+void WorkStealingPool::parallelFor(int count, const std::function<void(int index, int worker)>& job_in)
+{
+    if (count <= 0)
+        return;
+
+    std::unique_lock<std::mutex> lock(mutex);
+
+    //Contiguous blocks per worker
+    int workerCount = (int)queues.size();
+    for (int w = 0; w < workerCount; ++w)
+    {
+        std::lock_guard<std::mutex> queueLock(queues[w]->mutex);
+        int begin = (int)((long long)count * w / workerCount);
+        int end = (int)((long long)count * (w + 1) / workerCount);
+        for (int i = begin; i < end; ++i)
+        {
+            queues[w]->indices.push_back(i);
+        }
+    }
+
+    job = &job_in;
+    remaining = count;
+    ++generation;
+    wakeWorkers.notify_all();
+
+    //A worker that is late to wake up must not pick up indices of the next call with this job
+    jobFinished.wait(lock, [this] { return remaining == 0 && activeWorkers == 0; });
+    job = nullptr;
+}
+
+int WorkStealingPool::getThreadCount() const
+{
+    return (int)threads.size();
+}
+
+void WorkStealingPool::workerLoop(int worker)
+{
+    unsigned long long served = 0;
+    while (true)
+    {
+        const std::function<void(int, int)>* currentJob;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            wakeWorkers.wait(lock, [&] { return stopping || (generation != served && job != nullptr); });
+            if (stopping)
+                return;
+            served = generation;
+            currentJob = job;
+            ++activeWorkers;
+        }
+
+        int index;
+        while (popOrSteal(worker, index))
+        {
+            (*currentJob)(index, worker);
+            --remaining;
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            --activeWorkers;
+        }
+        jobFinished.notify_one();
+    }
+}
+
+bool WorkStealingPool::popOrSteal(int worker, int& index)
+{
+    //Own queue, front
+    {
+        Queue& own = *queues[worker];
+        std::lock_guard<std::mutex> lock(own.mutex);
+        if (!own.indices.empty())
+        {
+            index = own.indices.front();
+            own.indices.pop_front();
+            return true;
+        }
+    }
+
+    //Other queues, back. Start at the neighbour so thieves spread over the victims.
+    int workerCount = (int)queues.size();
+    for (int offset = 1; offset < workerCount; ++offset)
+    {
+        Queue& victim = *queues[(worker + offset) % workerCount];
+        std::lock_guard<std::mutex> lock(victim.mutex);
+        if (!victim.indices.empty())
+        {
+            index = victim.indices.back();
+            victim.indices.pop_back();
+            return true;
+        }
+    }
+    return false;
+}
@@ -0,0 +1,63 @@
+#pragma once
+#ifndef WORK_STEALING_POOL_H
+#define WORK_STEALING_POOL_H
+
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <atomic>
+
+
+/*
+    Fixed set of worker threads that run index based jobs.
+ 
+    parallelFor deals the indices out to the workers in contiguous blocks (neighbouring tiles
+    stay on one core). A worker pops from the front of its own queue and, once that is empty,
+    steals from the back of the other queues, so expensive regions of the image do not leave
+    the remaining cores idle.
+*/
+class WorkStealingPool
+{
+public:
+    //0 threads means one per hardware thread
+    WorkStealingPool(int threadCount = 0);
+    ~WorkStealingPool();
+
+    WorkStealingPool(const WorkStealingPool&) = delete;
+    WorkStealingPool& operator=(const WorkStealingPool&) = delete;
+
+    //Runs job(index, worker) for every index in [0, count) and returns once all of them finished
+    void parallelFor(int count, const std::function<void(int index, int worker)>& job);
+    int getThreadCount() const;
+
+private:
+    struct Queue
+    {
+        std::mutex mutex;
+        std::deque<int> indices;
+    };
+
+    void workerLoop(int worker);
+    bool popOrSteal(int worker, int& index);
+
+private:
+    std::vector<std::thread> threads;
+    std::vector<std::unique_ptr<Queue>> queues;
+
+    std::mutex mutex;
+    std::condition_variable wakeWorkers;
+    std::condition_variable jobFinished;
+    const std::function<void(int, int)>* job;
+    //Incremented for every parallelFor call, workers compare it with the last one they served
+    unsigned long long generation;
+    //Workers that may still touch the current job
+    int activeWorkers;
+    std::atomic<int> remaining;
+    bool stopping;
+};
+
+#endif
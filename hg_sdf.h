@@ -0,0 +1,1012 @@
+#pragma once
+#ifndef HG_SDF_H
+#define HG_SDF_H
+
+#include <cmath>
+#include <type_traits>
+#include <utility>
+
+/*
+    C++ port of Shaders/hg_sdf.glsl (MERCURY, MIT OR CC-BY-NC-4.0).
+
+    Header only and templated on the scalar type T, so one implementation serves float, double,
+    the SIMD lanes of SimdLanes.h and dual numbers. Names and behaviour follow the GLSL library
+    one to one so C++ code reads like the fragment shaders:
+    - GLSL "inout" arguments become references. C++ has no swizzles, so the 2D domain operators
+      also take the two components separately: pR(p.xz, a) in GLSL is written pR(p.x, p.z, a).
+    - Branches are written with select(condition, a, b). Conditions are bool for built-in types
+      and masks for lane types, which evaluate both sides and blend them.
+    - Sizes and radii are plain parameters of type T that are not deduced, fSphere(p, 6.0f) works
+      for every T. Repetition and step counts stay float since they pick code paths.
+    - Everything is constexpr. Functions built from arithmetic, comparisons and floor evaluate at
+      compile time for float and double, the others as far as the standard library allows.
+
+    Types other than float and double must provide the arithmetic operators, comparisons and
+    select, any, min, max, abs, floor, sqrt, sin, cos, atan2 and pow in their own namespace.
+*/
+namespace hg
+{
+    //Keeps T from being deduced from a parameter, fSphere(lanes, 6.0f) converts 6.0f to the lane type
+    template<typename T>
+    struct identity
+    {
+        using type = T;
+    };
+
+    template<typename T>
+    using same_t = typename identity<T>::type;
+
+    //bool for float and double, the mask type for lanes
+    template<typename T>
+    using mask_t = decltype(std::declval<T>() < std::declval<T>());
+
+    template<typename T>
+    using EnableIfFloat = typename std::enable_if<std::is_floating_point<T>::value, int>::type;
+
+    namespace detail
+    {
+        //Newton iterations, only used for the constants below
+        constexpr double sqrtNewton(double x, double guess, int iterations)
+        {
+            return iterations == 0 ? guess : sqrtNewton(x, 0.5 * (guess + x / guess), iterations - 1);
+        }
+
+        constexpr double constSqrt(double x)
+        {
+            return sqrtNewton(x, x > 1.0 ? x : 1.0, 64);
+        }
+    }
+
+    constexpr double PI = 3.14159265358979323846;
+    constexpr double TAU = 2.0 * PI;
+    constexpr double PHI = detail::constSqrt(5.0) * 0.5 + 0.5;
+    constexpr double SQRT2 = detail::constSqrt(2.0);
+    constexpr double SQRT3 = detail::constSqrt(3.0);
+    constexpr double SQRT_HALF = detail::constSqrt(0.5);
+
+    ////////////////////////////////////////////////////////////////
+    //             SCALAR OPERATIONS FOR float AND double
+    ////////////////////////////////////////////////////////////////
+
+    template<typename T, EnableIfFloat<T> = 0>
+    constexpr T select(bool condition, T a, T b)
+    {
+        return condition ? a : b;
+    }
+
+    constexpr bool any(bool condition)
+    {
+        return condition;
+    }
+
+    template<typename T, EnableIfFloat<T> = 0>
+    constexpr T min(T a, T b)
+    {
+        return (a < b) ? a : b;
+    }
+
+    template<typename T, EnableIfFloat<T> = 0>
+    constexpr T max(T a, T b)
+    {
+        return (a > b) ? a : b;
+    }
+
+    template<typename T, EnableIfFloat<T> = 0>
+    constexpr T abs(T x)
+    {
+        return (x < T(0)) ? -x : x;
+    }
+
+    template<typename T, EnableIfFloat<T> = 0>
+    constexpr T floor(T x)
+    {
+        //Past 2^52 every float and double is integral, NaN falls through as well
+        if (!(abs(x) < T(4503599627370496.0)))
+            return x;
+        T i = T(static_cast<long long>(x));
+        return (i > x) ? i - T(1) : i;
+    }
+
+    template<typename T, EnableIfFloat<T> = 0>
+    constexpr T sqrt(T x)
+    {
+        return std::sqrt(x);
+    }
+
+    template<typename T, EnableIfFloat<T> = 0>
+    constexpr T sin(T x)
+    {
+        return std::sin(x);
+    }
+
+    template<typename T, EnableIfFloat<T> = 0>
+    constexpr T cos(T x)
+    {
+        return std::cos(x);
+    }
+
+    template<typename T, EnableIfFloat<T> = 0>
+    constexpr T atan2(T y, T x)
+    {
+        return std::atan2(y, x);
+    }
+
+    template<typename T, EnableIfFloat<T> = 0>
+    constexpr T pow(T x, T e)
+    {
+        return std::pow(x, e);
+    }
+
+    ////////////////////////////////////////////////////////////////
+    //             GLSL BUILT-INS
+    ////////////////////////////////////////////////////////////////
+
+    //GLSL mod: result has the sign of y
+    template<typename T>
+    constexpr T mod(T x, T y)
+    {
+        return x - y * floor(x / y);
+    }
+
+    template<typename T>
+    constexpr T fract(T x)
+    {
+        return x - floor(x);
+    }
+
+    template<typename T>
+    constexpr T clamp(T x, same_t<T> lo, same_t<T> hi)
+    {
+        return min(max(x, lo), hi);
+    }
+
+    template<typename T>
+    constexpr T saturate(T x)
+    {
+        return clamp(x, T(0), T(1));
+    }
+
+    template<typename T>
+    constexpr T mix(T a, same_t<T> b, same_t<T> t)
+    {
+        return a * (T(1) - t) + b * t;
+    }
+
+    ////////////////////////////////////////////////////////////////
+    //             VECTORS
+    ////////////////////////////////////////////////////////////////
+
+    template<typename T>
+    struct vec2
+    {
+        T x, y;
+
+        constexpr vec2() : x(T(0)), y(T(0)) {}
+        constexpr explicit vec2(T s) : x(s), y(s) {}
+        constexpr vec2(T x_in, T y_in) : x(x_in), y(y_in) {}
+        //e.g. float constants to lanes
+        template<typename U>
+        constexpr vec2(const vec2<U>& v) : x(T(v.x)), y(T(v.y)) {}
+
+        constexpr vec2& operator+=(const vec2& v) { x = x + v.x; y = y + v.y; return *this; }
+        constexpr vec2& operator-=(const vec2& v) { x = x - v.x; y = y - v.y; return *this; }
+        constexpr vec2& operator*=(const vec2& v) { x = x * v.x; y = y * v.y; return *this; }
+        constexpr vec2& operator*=(T s) { x = x * s; y = y * s; return *this; }
+    };
+
+    template<typename T>
+    struct vec3
+    {
+        T x, y, z;
+
+        constexpr vec3() : x(T(0)), y(T(0)), z(T(0)) {}
+        constexpr explicit vec3(T s) : x(s), y(s), z(s) {}
+        constexpr vec3(T x_in, T y_in, T z_in) : x(x_in), y(y_in), z(z_in) {}
+        template<typename U>
+        constexpr vec3(const vec3<U>& v) : x(T(v.x)), y(T(v.y)), z(T(v.z)) {}
+
+        constexpr vec3& operator+=(const vec3& v) { x = x + v.x; y = y + v.y; z = z + v.z; return *this; }
+        constexpr vec3& operator-=(const vec3& v) { x = x - v.x; y = y - v.y; z = z - v.z; return *this; }
+        constexpr vec3& operator*=(const vec3& v) { x = x * v.x; y = y * v.y; z = z * v.z; return *this; }
+        constexpr vec3& operator*=(T s) { x = x * s; y = y * s; z = z * s; return *this; }
+    };
+
+    template<typename T>
+    struct vec4
+    {
+        T x, y, z, w;
+
+        constexpr vec4() : x(T(0)), y(T(0)), z(T(0)), w(T(0)) {}
+        constexpr explicit vec4(T s) : x(s), y(s), z(s), w(s) {}
+        constexpr vec4(T x_in, T y_in, T z_in, T w_in) : x(x_in), y(y_in), z(z_in), w(w_in) {}
+        template<typename U>
+        constexpr vec4(const vec4<U>& v) : x(T(v.x)), y(T(v.y)), z(T(v.z)), w(T(v.w)) {}
+    };
+
+    template<typename T> constexpr vec2<T> operator+(const vec2<T>& a, const vec2<T>& b) { return vec2<T>(a.x + b.x, a.y + b.y); }
+    template<typename T> constexpr vec2<T> operator-(const vec2<T>& a, const vec2<T>& b) { return vec2<T>(a.x - b.x, a.y - b.y); }
+    template<typename T> constexpr vec2<T> operator*(const vec2<T>& a, const vec2<T>& b) { return vec2<T>(a.x * b.x, a.y * b.y); }
+    template<typename T> constexpr vec2<T> operator/(const vec2<T>& a, const vec2<T>& b) { return vec2<T>(a.x / b.x, a.y / b.y); }
+    template<typename T> constexpr vec2<T> operator*(const vec2<T>& a, same_t<T> s) { return vec2<T>(a.x * s, a.y * s); }
+    template<typename T> constexpr vec2<T> operator*(same_t<T> s, const vec2<T>& a) { return vec2<T>(s * a.x, s * a.y); }
+    template<typename T> constexpr vec2<T> operator/(const vec2<T>& a, same_t<T> s) { return vec2<T>(a.x / s, a.y / s); }
+    template<typename T> constexpr vec2<T> operator-(const vec2<T>& a) { return vec2<T>(-a.x, -a.y); }
+
+    template<typename T> constexpr vec3<T> operator+(const vec3<T>& a, const vec3<T>& b) { return vec3<T>(a.x + b.x, a.y + b.y, a.z + b.z); }
+    template<typename T> constexpr vec3<T> operator-(const vec3<T>& a, const vec3<T>& b) { return vec3<T>(a.x - b.x, a.y - b.y, a.z - b.z); }
+    template<typename T> constexpr vec3<T> operator*(const vec3<T>& a, const vec3<T>& b) { return vec3<T>(a.x * b.x, a.y * b.y, a.z * b.z); }
+    template<typename T> constexpr vec3<T> operator/(const vec3<T>& a, const vec3<T>& b) { return vec3<T>(a.x / b.x, a.y / b.y, a.z / b.z); }
+    template<typename T> constexpr vec3<T> operator+(const vec3<T>& a, same_t<T> s) { return vec3<T>(a.x + s, a.y + s, a.z + s); }
+    template<typename T> constexpr vec3<T> operator-(const vec3<T>& a, same_t<T> s) { return vec3<T>(a.x - s, a.y - s, a.z - s); }
+    template<typename T> constexpr vec3<T> operator*(const vec3<T>& a, same_t<T> s) { return vec3<T>(a.x * s, a.y * s, a.z * s); }
+    template<typename T> constexpr vec3<T> operator*(same_t<T> s, const vec3<T>& a) { return vec3<T>(s * a.x, s * a.y, s * a.z); }
+    template<typename T> constexpr vec3<T> operator/(const vec3<T>& a, same_t<T> s) { return vec3<T>(a.x / s, a.y / s, a.z / s); }
+    template<typename T> constexpr vec3<T> operator-(const vec3<T>& a) { return vec3<T>(-a.x, -a.y, -a.z); }
+
+    template<typename T> constexpr T dot(const vec2<T>& a, const vec2<T>& b) { return a.x * b.x + a.y * b.y; }
+    template<typename T> constexpr T dot(const vec3<T>& a, const vec3<T>& b) { return a.x * b.x + a.y * b.y + a.z * b.z; }
+    template<typename T> constexpr T length(const vec2<T>& v) { return sqrt(dot(v, v)); }
+    template<typename T> constexpr T length(const vec3<T>& v) { return sqrt(dot(v, v)); }
+    template<typename T> constexpr vec2<T> normalize(const vec2<T>& v) { return v / length(v); }
+    template<typename T> constexpr vec3<T> normalize(const vec3<T>& v) { return v / length(v); }
+
+    template<typename T> constexpr vec2<T> abs(const vec2<T>& v) { return vec2<T>(abs(v.x), abs(v.y)); }
+    template<typename T> constexpr vec3<T> abs(const vec3<T>& v) { return vec3<T>(abs(v.x), abs(v.y), abs(v.z)); }
+    template<typename T> constexpr vec2<T> floor(const vec2<T>& v) { return vec2<T>(floor(v.x), floor(v.y)); }
+    template<typename T> constexpr vec3<T> floor(const vec3<T>& v) { return vec3<T>(floor(v.x), floor(v.y), floor(v.z)); }
+    template<typename T> constexpr vec2<T> min(const vec2<T>& a, const vec2<T>& b) { return vec2<T>(min(a.x, b.x), min(a.y, b.y)); }
+    template<typename T> constexpr vec3<T> min(const vec3<T>& a, const vec3<T>& b) { return vec3<T>(min(a.x, b.x), min(a.y, b.y), min(a.z, b.z)); }
+    template<typename T> constexpr vec2<T> max(const vec2<T>& a, const vec2<T>& b) { return vec2<T>(max(a.x, b.x), max(a.y, b.y)); }
+    template<typename T> constexpr vec3<T> max(const vec3<T>& a, const vec3<T>& b) { return vec3<T>(max(a.x, b.x), max(a.y, b.y), max(a.z, b.z)); }
+    template<typename T> constexpr vec2<T> mod(const vec2<T>& x, const vec2<T>& y) { return vec2<T>(mod(x.x, y.x), mod(x.y, y.y)); }
+    template<typename T> constexpr vec3<T> mod(const vec3<T>& x, const vec3<T>& y) { return vec3<T>(mod(x.x, y.x), mod(x.y, y.y), mod(x.z, y.z)); }
+
+    template<typename M, typename T>
+    constexpr vec2<T> select(const M& condition, const vec2<T>& a, const vec2<T>& b)
+    {
+        return vec2<T>(select(condition, a.x, b.x), select(condition, a.y, b.y));
+    }
+
+    template<typename M, typename T>
+    constexpr vec3<T> select(const M& condition, const vec3<T>& a, const vec3<T>& b)
+    {
+        return vec3<T>(select(condition, a.x, b.x), select(condition, a.y, b.y), select(condition, a.z, b.z));
+    }
+
+    ////////////////////////////////////////////////////////////////
+    //
+    //             HELPER FUNCTIONS/MACROS
+    //
+    ////////////////////////////////////////////////////////////////
+
+    // Sign function that doesn't return 0
+    template<typename T>
+    constexpr T sgn(T x)
+    {
+        return select(x < T(0), T(-1), T(1));
+    }
+
+    template<typename T>
+    constexpr vec2<T> sgn(const vec2<T>& v)
+    {
+        return vec2<T>(sgn(v.x), sgn(v.y));
+    }
+
+    template<typename T>
+    constexpr T square(T x)
+    {
+        return x * x;
+    }
+
+    template<typename T>
+    constexpr vec2<T> square(const vec2<T>& x)
+    {
+        return x * x;
+    }
+
+    template<typename T>
+    constexpr vec3<T> square(const vec3<T>& x)
+    {
+        return x * x;
+    }
+
+    template<typename T>
+    constexpr T lengthSqr(const vec3<T>& x)
+    {
+        return dot(x, x);
+    }
+
+    // Maximum/minumum elements of a vector
+    template<typename T>
+    constexpr T vmax(const vec2<T>& v)
+    {
+        return max(v.x, v.y);
+    }
+
+    template<typename T>
+    constexpr T vmax(const vec3<T>& v)
+    {
+        return max(max(v.x, v.y), v.z);
+    }
+
+    template<typename T>
+    constexpr T vmax(const vec4<T>& v)
+    {
+        return max(max(v.x, v.y), max(v.z, v.w));
+    }
+
+    template<typename T>
+    constexpr T vmin(const vec2<T>& v)
+    {
+        return min(v.x, v.y);
+    }
+
+    template<typename T>
+    constexpr T vmin(const vec3<T>& v)
+    {
+        return min(min(v.x, v.y), v.z);
+    }
+
+    template<typename T>
+    constexpr T vmin(const vec4<T>& v)
+    {
+        return min(min(v.x, v.y), min(v.z, v.w));
+    }
+
+    ////////////////////////////////////////////////////////////////
+    //
+    //             PRIMITIVE DISTANCE FUNCTIONS
+    //
+    ////////////////////////////////////////////////////////////////
+
+    template<typename T>
+    constexpr T fSphere(const vec3<T>& p, same_t<T> r)
+    {
+        return length(p) - r;
+    }
+
+    // Plane with normal n (n is normalized) at some distance from the origin
+    template<typename T>
+    constexpr T fPlane(const vec3<T>& p, const vec3<same_t<T>>& n, same_t<T> distanceFromOrigin)
+    {
+        return dot(p, n) + distanceFromOrigin;
+    }
+
+    // Cheap Box: distance to corners is overestimated
+    template<typename T>
+    constexpr T fBoxCheap(const vec3<T>& p, const vec3<same_t<T>>& b)
+    {
+        return vmax(abs(p) - b);
+    }
+
+    // Box: correct distance to corners
+    template<typename T>
+    constexpr T fBox(const vec3<T>& p, const vec3<same_t<T>>& b)
+    {
+        vec3<T> d = abs(p) - b;
+        return length(max(d, vec3<T>(T(0)))) + vmax(min(d, vec3<T>(T(0))));
+    }
+
+    // Same as above, but in two dimensions (an endless box)
+    template<typename T>
+    constexpr T fBox2Cheap(const vec2<T>& p, const vec2<same_t<T>>& b)
+    {
+        return vmax(abs(p) - b);
+    }
+
+    template<typename T>
+    constexpr T fBox2(const vec2<T>& p, const vec2<same_t<T>>& b)
+    {
+        vec2<T> d = abs(p) - b;
+        return length(max(d, vec2<T>(T(0)))) + vmax(min(d, vec2<T>(T(0))));
+    }
+
+    // Endless "corner"
+    template<typename T>
+    constexpr T fCorner(const vec2<T>& p)
+    {
+        return length(max(p, vec2<T>(T(0)))) + vmax(min(p, vec2<T>(T(0))));
+    }
+
+    // Blobby ball object. You've probably seen it somewhere. This is not a correct distance bound, beware.
+    template<typename T>
+    constexpr T fBlob(vec3<T> p)
+    {
+        p = abs(p);
+        p = select(p.x < max(p.y, p.z), vec3<T>(p.y, p.z, p.x), p);
+        p = select(p.x < max(p.y, p.z), vec3<T>(p.y, p.z, p.x), p);
+        const double n3 = 1.0 / SQRT3;
+        const double nPhi1 = 1.0 / detail::constSqrt((PHI + 1.0) * (PHI + 1.0) + 1.0);
+        const double nPhi = 1.0 / detail::constSqrt(1.0 + PHI * PHI);
+        T b = max(max(max(
+            dot(p, vec3<T>(T(n3), T(n3), T(n3))),
+            dot(vec2<T>(p.x, p.z), vec2<T>(T((PHI + 1.0) * nPhi1), T(nPhi1)))),
+            dot(vec2<T>(p.y, p.x), vec2<T>(T(nPhi), T(PHI * nPhi)))),
+            dot(vec2<T>(p.x, p.z), vec2<T>(T(nPhi), T(PHI * nPhi))));
+        T l = length(p);
+        return l - T(1.5) - T(0.2 * (1.5 / 2)) * cos(min(sqrt(T(1.01) - b / l) * T(PI / 0.25), T(PI)));
+    }
+
+    // Cylinder standing upright on the xz plane
+    template<typename T>
+    constexpr T fCylinder(const vec3<T>& p, same_t<T> r, same_t<T> height)
+    {
+        T d = length(vec2<T>(p.x, p.z)) - r;
+        d = max(d, abs(p.y) - height);
+        return d;
+    }
+
+    // Capsule: A Cylinder with round caps on both sides
+    template<typename T>
+    constexpr T fCapsule(const vec3<T>& p, same_t<T> r, same_t<T> c)
+    {
+        return select(abs(p.y) >= c,
+                      length(vec3<T>(p.x, abs(p.y) - c, p.z)) - r,
+                      length(vec2<T>(p.x, p.z)) - r);
+    }
+
+    // Distance to line segment between <a> and <b>, used for fCapsule() version 2below
+    template<typename T>
+    constexpr T fLineSegment(const vec3<T>& p, const vec3<same_t<T>>& a, const vec3<same_t<T>>& b)
+    {
+        vec3<T> ab = b - a;
+        T t = saturate(dot(p - a, ab) / dot(ab, ab));
+        return length((ab * t + a) - p);
+    }
+
+    // Capsule version 2: between two end points <a> and <b> with radius r
+    template<typename T>
+    constexpr T fCapsule(const vec3<T>& p, const vec3<same_t<T>>& a, const vec3<same_t<T>>& b, same_t<T> r)
+    {
+        return fLineSegment(p, a, b) - r;
+    }
+
+    // Torus in the XZ-plane
+    template<typename T>
+    constexpr T fTorus(const vec3<T>& p, same_t<T> smallRadius, same_t<T> largeRadius)
+    {
+        return length(vec2<T>(length(vec2<T>(p.x, p.z)) - largeRadius, p.y)) - smallRadius;
+    }
+
+    // A circle line. Can also be used to make a torus by subtracting the smaller radius of the torus.
+    template<typename T>
+    constexpr T fCircle(const vec3<T>& p, same_t<T> r)
+    {
+        T l = length(vec2<T>(p.x, p.z)) - r;
+        return length(vec2<T>(p.y, l));
+    }
+
+    // A circular disc with no thickness (i.e. a cylinder with no height).
+    // Subtract some value to make a flat disc with rounded edge.
+    template<typename T>
+    constexpr T fDisc(const vec3<T>& p, same_t<T> r)
+    {
+        T l = length(vec2<T>(p.x, p.z)) - r;
+        return select(l < T(0), abs(p.y), length(vec2<T>(p.y, l)));
+    }
+
+    // Hexagonal prism, circumcircle variant
+    template<typename T>
+    constexpr T fHexagonCircumcircle(const vec3<T>& p, const vec2<same_t<T>>& h)
+    {
+        vec3<T> q = abs(p);
+        return max(q.y - h.y, max(q.x * T(SQRT3 * 0.5) + q.z * T(0.5), q.z) - h.x);
+    }
+
+    // Hexagonal prism, incircle variant
+    template<typename T>
+    constexpr T fHexagonIncircle(const vec3<T>& p, const vec2<same_t<T>>& h)
+    {
+        return fHexagonCircumcircle(p, vec2<T>(h.x * T(SQRT3 * 0.5), h.y));
+    }
+
+    // Cone with correct distances to tip and base circle. Y is up, 0 is in the middle of the base.
+    template<typename T>
+    constexpr T fCone(const vec3<T>& p, same_t<T> radius, same_t<T> height)
+    {
+        vec2<T> q = vec2<T>(length(vec2<T>(p.x, p.z)), p.y);
+        vec2<T> tip = q - vec2<T>(T(0), height);
+        vec2<T> mantleDir = normalize(vec2<T>(height, radius));
+        T mantle = dot(tip, mantleDir);
+        T d = max(mantle, -q.y);
+        T projected = dot(tip, vec2<T>(mantleDir.y, -mantleDir.x));
+
+        // distance to tip
+        d = select((q.y > height) & (projected < T(0)), max(d, length(tip)), d);
+
+        // distance to base ring
+        d = select((q.x > radius) & (projected > length(vec2<T>(height, radius))),
+                   max(d, length(q - vec2<T>(radius, T(0)))), d);
+        return d;
+    }
+
+    //
+    // "Generalized Distance Functions" by Akleman and Chen.
+    // see the Paper at https://www.viz.tamu.edu/faculty/ergun/research/implicitmodeling/papers/sm99.pdf
+    //
+    // This set of constants is used to construct a large variety of geometric primitives.
+    // Indices are shifted by 1 compared to the paper because we start counting at Zero.
+    // Some of those are slow whenever a driver decides to not unroll the loop,
+    // which seems to happen for fIcosahedron und fTruncatedIcosahedron on nvidia 350.12 at least.
+    // Specialized implementations can well be faster in all cases.
+    //
+    namespace detail
+    {
+        constexpr vec3<double> normalized(double x, double y, double z)
+        {
+            return vec3<double>(x, y, z) / constSqrt(x * x + y * y + z * z);
+        }
+    }
+
+    constexpr vec3<double> GDFVectors[19] = {
+        detail::normalized(1, 0, 0),
+        detail::normalized(0, 1, 0),
+        detail::normalized(0, 0, 1),
+
+        detail::normalized(1, 1, 1 ),
+        detail::normalized(-1, 1, 1),
+        detail::normalized(1, -1, 1),
+        detail::normalized(1, 1, -1),
+
+        detail::normalized(0, 1, PHI+1),
+        detail::normalized(0, -1, PHI+1),
+        detail::normalized(PHI+1, 0, 1),
+        detail::normalized(-PHI-1, 0, 1),
+        detail::normalized(1, PHI+1, 0),
+        detail::normalized(-1, PHI+1, 0),
+
+        detail::normalized(0, PHI, 1),
+        detail::normalized(0, -PHI, 1),
+        detail::normalized(1, 0, PHI),
+        detail::normalized(-1, 0, PHI),
+        detail::normalized(PHI, 1, 0),
+        detail::normalized(-PHI, 1, 0)
+    };
+
+    // Version with variable exponent.
+    // This is slow and does not produce correct distances, but allows for bulging of objects.
+    template<typename T>
+    constexpr T fGDF(const vec3<T>& p, same_t<T> r, same_t<T> e, int begin, int end)
+    {
+        T d = T(0);
+        for (int i = begin; i <= end; ++i)
+            d = d + pow(abs(dot(p, vec3<T>(GDFVectors[i]))), e);
+        return pow(d, T(1) / e) - r;
+    }
+
+    // Version with without exponent, creates objects with sharp edges and flat faces
+    template<typename T>
+    constexpr T fGDF(const vec3<T>& p, same_t<T> r, int begin, int end)
+    {
+        T d = T(0);
+        for (int i = begin; i <= end; ++i)
+            d = max(d, abs(dot(p, vec3<T>(GDFVectors[i]))));
+        return d - r;
+    }
+
+    // Primitives follow:
+
+    template<typename T>
+    constexpr T fOctahedron(const vec3<T>& p, same_t<T> r, same_t<T> e)
+    {
+        return fGDF(p, r, e, 3, 6);
+    }
+
+    template<typename T>
+    constexpr T fDodecahedron(const vec3<T>& p, same_t<T> r, same_t<T> e)
+    {
+        return fGDF(p, r, e, 13, 18);
+    }
+
+    template<typename T>
+    constexpr T fIcosahedron(const vec3<T>& p, same_t<T> r, same_t<T> e)
+    {
+        return fGDF(p, r, e, 3, 12);
+    }
+
+    template<typename T>
+    constexpr T fTruncatedOctahedron(const vec3<T>& p, same_t<T> r, same_t<T> e)
+    {
+        return fGDF(p, r, e, 0, 6);
+    }
+
+    template<typename T>
+    constexpr T fTruncatedIcosahedron(const vec3<T>& p, same_t<T> r, same_t<T> e)
+    {
+        return fGDF(p, r, e, 3, 18);
+    }
+
+    template<typename T>
+    constexpr T fOctahedron(const vec3<T>& p, same_t<T> r)
+    {
+        return fGDF(p, r, 3, 6);
+    }
+
+    template<typename T>
+    constexpr T fDodecahedron(const vec3<T>& p, same_t<T> r)
+    {
+        return fGDF(p, r, 13, 18);
+    }
+
+    template<typename T>
+    constexpr T fIcosahedron(const vec3<T>& p, same_t<T> r)
+    {
+        return fGDF(p, r, 3, 12);
+    }
+
+    template<typename T>
+    constexpr T fTruncatedOctahedron(const vec3<T>& p, same_t<T> r)
+    {
+        return fGDF(p, r, 0, 6);
+    }
+
+    template<typename T>
+    constexpr T fTruncatedIcosahedron(const vec3<T>& p, same_t<T> r)
+    {
+        return fGDF(p, r, 3, 18);
+    }
+
+    ////////////////////////////////////////////////////////////////
+    //
+    //                DOMAIN MANIPULATION OPERATORS
+    //
+    ////////////////////////////////////////////////////////////////
+
+    // Rotate around a coordinate axis (i.e. in a plane perpendicular to that axis) by angle <a>.
+    // Read like this: R(p.xz, a) rotates "x towards z".
+    // The angle can be a T or a plain float, lane types then compute its sine and cosine once.
+    template<typename T, typename A>
+    constexpr void pR(T& x, T& y, A a)
+    {
+        T c = T(cos(a));
+        T s = T(sin(a));
+        T rx = c * x + s * y;
+        y = c * y - s * x;
+        x = rx;
+    }
+
+    template<typename T, typename A>
+    constexpr void pR(vec2<T>& p, A a)
+    {
+        pR(p.x, p.y, a);
+    }
+
+    // Shortcut for 45-degrees rotation
+    template<typename T>
+    constexpr void pR45(vec2<T>& p)
+    {
+        p = (p + vec2<T>(p.y, -p.x)) * T(SQRT_HALF);
+    }
+
+    // Repeat space along one axis. Use like this to repeat along the x axis:
+    // <float cell = pMod1(p.x,5);> - using the return value is optional.
+    template<typename T>
+    constexpr T pMod1(T& p, same_t<T> size)
+    {
+        T halfsize = size * T(0.5);
+        T c = floor((p + halfsize) / size);
+        p = mod(p + halfsize, size) - halfsize;
+        return c;
+    }
+
+    // Same, but mirror every second cell so they match at the boundaries
+    template<typename T>
+    constexpr T pModMirror1(T& p, same_t<T> size)
+    {
+        T halfsize = size * T(0.5);
+        T c = floor((p + halfsize) / size);
+        p = mod(p + halfsize, size) - halfsize;
+        p = p * (mod(c, T(2)) * T(2) - T(1));
+        return c;
+    }
+
+    // Repeat the domain only in positive direction. Everything in the negative half-space is unchanged.
+    template<typename T>
+    constexpr T pModSingle1(T& p, same_t<T> size)
+    {
+        T halfsize = size * T(0.5);
+        T c = floor((p + halfsize) / size);
+        p = select(p >= T(0), mod(p + halfsize, size) - halfsize, p);
+        return c;
+    }
+
+    // Repeat only a few times: from indices <start> to <stop> (similar to above, but more flexible)
+    template<typename T>
+    constexpr T pModInterval1(T& p, same_t<T> size, same_t<T> start, same_t<T> stop)
+    {
+        T halfsize = size * T(0.5);
+        T c = floor((p + halfsize) / size);
+        p = mod(p + halfsize, size) - halfsize;
+        auto above = c > stop;
+        p = select(above, p + size * (c - stop), p);
+        c = select(above, stop, c);
+        auto below = c < start;
+        p = select(below, p + size * (c - start), p);
+        c = select(below, start, c);
+        return c;
+    }
+
+    // Repeat around the origin by a fixed angle.
+    // For easier use, num of repetitions is use to specify the angle.
+    template<typename T>
+    constexpr T pModPolar(T& x, T& y, float repetitions)
+    {
+        T angle = T(2 * PI / repetitions);
+        T a = atan2(y, x) + angle / T(2);
+        T r = length(vec2<T>(x, y));
+        T c = floor(a / angle);
+        a = mod(a, angle) - angle / T(2);
+        x = cos(a) * r;
+        y = sin(a) * r;
+        // For an odd number of repetitions, fix cell index of the cell in -x direction
+        // (cell index would be e.g. -5 and 5 in the two halves of the cell):
+        c = select(abs(c) >= T(repetitions / 2), abs(c), c);
+        return c;
+    }
+
+    template<typename T>
+    constexpr T pModPolar(vec2<T>& p, float repetitions)
+    {
+        return pModPolar(p.x, p.y, repetitions);
+    }
+
+    // Repeat in two dimensions
+    template<typename T>
+    constexpr vec2<T> pMod2(T& x, T& y, const vec2<same_t<T>>& size)
+    {
+        return vec2<T>(pMod1(x, size.x), pMod1(y, size.y));
+    }
+
+    template<typename T>
+    constexpr vec2<T> pMod2(vec2<T>& p, const vec2<same_t<T>>& size)
+    {
+        return pMod2(p.x, p.y, size);
+    }
+
+    // Same, but mirror every second cell so all boundaries match
+    template<typename T>
+    constexpr vec2<T> pModMirror2(vec2<T>& p, const vec2<same_t<T>>& size)
+    {
+        return vec2<T>(pModMirror1(p.x, size.x), pModMirror1(p.y, size.y));
+    }
+
+    // Same, but mirror every second cell at the diagonal as well
+    template<typename T>
+    constexpr vec2<T> pModGrid2(vec2<T>& p, const vec2<same_t<T>>& size)
+    {
+        vec2<T> c = floor((p + size * T(0.5)) / size);
+        p = mod(p + size * T(0.5), vec2<T>(size)) - size * T(0.5);
+        p *= mod(c, vec2<T>(T(2))) * T(2) - vec2<T>(T(1));
+        p -= size / T(2);
+        auto swap = p.x > p.y;
+        p = select(swap, vec2<T>(p.y, p.x), p);
+        return floor(c / T(2));
+    }
+
+    // Repeat in three dimensions
+    template<typename T>
+    constexpr vec3<T> pMod3(vec3<T>& p, const vec3<same_t<T>>& size)
+    {
+        return vec3<T>(pMod1(p.x, size.x), pMod1(p.y, size.y), pMod1(p.z, size.z));
+    }
+
+    // Mirror at an axis-aligned plane which is at a specified distance <dist> from the origin.
+    template<typename T>
+    constexpr T pMirror(T& p, same_t<T> dist)
+    {
+        T s = sgn(p);
+        p = abs(p) - dist;
+        return s;
+    }
+
+    // Mirror in both dimensions and at the diagonal, yielding one eighth of the space.
+    // translate by dist before mirroring.
+    template<typename T>
+    constexpr vec2<T> pMirrorOctant(T& x, T& y, const vec2<same_t<T>>& dist)
+    {
+        vec2<T> s = vec2<T>(sgn(x), sgn(y));
+        pMirror(x, dist.x);
+        pMirror(y, dist.y);
+        auto swap = y > x;
+        T mx = select(swap, y, x);
+        y = select(swap, x, y);
+        x = mx;
+        return s;
+    }
+
+    template<typename T>
+    constexpr vec2<T> pMirrorOctant(vec2<T>& p, const vec2<same_t<T>>& dist)
+    {
+        return pMirrorOctant(p.x, p.y, dist);
+    }
+
+    // Reflect space at a plane
+    template<typename T>
+    constexpr T pReflect(vec3<T>& p, const vec3<same_t<T>>& planeNormal, same_t<T> offset)
+    {
+        T t = dot(p, planeNormal) + offset;
+        p = select(t < T(0), p - planeNormal * (T(2) * t), p);
+        return sgn(t);
+    }
+
+    ////////////////////////////////////////////////////////////////
+    //
+    //             OBJECT COMBINATION OPERATORS
+    //
+    ////////////////////////////////////////////////////////////////
+
+    // The "Chamfer" flavour makes a 45-degree chamfered edge (the diagonal of a square of size <r>):
+    template<typename T>
+    constexpr T fOpUnionChamfer(T a, same_t<T> b, same_t<T> r)
+    {
+        return min(min(a, b), (a - r + b) * T(SQRT_HALF));
+    }
+
+    // Intersection has to deal with what is normally the inside of the resulting object
+    // when using union, which we normally don't care about too much. Thus, intersection
+    // implementations sometimes differ from union implementations.
+    template<typename T>
+    constexpr T fOpIntersectionChamfer(T a, same_t<T> b, same_t<T> r)
+    {
+        return max(max(a, b), (a + r + b) * T(SQRT_HALF));
+    }
+
+    // Difference can be built from Intersection or Union:
+    template<typename T>
+    constexpr T fOpDifferenceChamfer(T a, same_t<T> b, same_t<T> r)
+    {
+        return fOpIntersectionChamfer(a, -b, r);
+    }
+
+    // The "Round" variant uses a quarter-circle to join the two objects smoothly:
+    template<typename T>
+    constexpr T fOpUnionRound(T a, same_t<T> b, same_t<T> r)
+    {
+        vec2<T> u = max(vec2<T>(r - a, r - b), vec2<T>(T(0)));
+        return max(r, min(a, b)) - length(u);
+    }
+
+    template<typename T>
+    constexpr T fOpIntersectionRound(T a, same_t<T> b, same_t<T> r)
+    {
+        vec2<T> u = max(vec2<T>(r + a, r + b), vec2<T>(T(0)));
+        return min(-r, max(a, b)) + length(u);
+    }
+
+    template<typename T>
+    constexpr T fOpDifferenceRound(T a, same_t<T> b, same_t<T> r)
+    {
+        return fOpIntersectionRound(a, -b, r);
+    }
+
+    // The "Columns" flavour makes n-1 circular columns at a 45 degree angle:
+    template<typename T>
+    constexpr T fOpUnionColumns(T a, same_t<T> b, same_t<T> r, float n)
+    {
+        auto columns = (a < r) & (b < r);
+        if (!any(columns))
+        {
+            return min(a, b);
+        }
+
+        vec2<T> p = vec2<T>(a, b);
+        T columnradius = r * T(SQRT2 / ((n - 1) * 2 + SQRT2));
+        pR45(p);
+        p.x = p.x - T(SQRT2 / 2) * r;
+        p.x = p.x + columnradius * T(SQRT2);
+        if (mod(n, 2.0f) == 1.0f)
+        {
+            p.y = p.y + columnradius;
+        }
+        // At this point, we have turned 45 degrees and moved at a point on the
+        // diagonal that we want to place the columns on.
+        // Now, repeat the domain along this direction and place a circle.
+        pMod1(p.y, columnradius * T(2));
+        T result = length(p) - columnradius;
+        result = min(result, p.x);
+        result = min(result, a);
+        return select(columns, min(result, b), min(a, b));
+    }
+
+    template<typename T>
+    constexpr T fOpDifferenceColumns(T a, same_t<T> b, same_t<T> r, float n)
+    {
+        a = -a;
+        T m = min(a, b);
+        //avoid the expensive computation where not needed (produces discontinuity though)
+        auto columns = (a < r) & (b < r);
+        if (!any(columns))
+        {
+            return -m;
+        }
+
+        vec2<T> p = vec2<T>(a, b);
+        T columnradius = r * T(SQRT2 / ((n - 1) * 2 + SQRT2));
+
+        pR45(p);
+        p.y = p.y + columnradius;
+        p.x = p.x - T(SQRT2 / 2) * r;
+        p.x = p.x + -columnradius * T(SQRT2 / 2);
+
+        if (mod(n, 2.0f) == 1.0f)
+        {
+            p.y = p.y + columnradius;
+        }
+        pMod1(p.y, columnradius * T(2));
+
+        T result = -length(p) + columnradius;
+        result = max(result, p.x);
+        result = min(result, a);
+        return select(columns, -min(result, b), -m);
+    }
+
+    template<typename T>
+    constexpr T fOpIntersectionColumns(T a, same_t<T> b, same_t<T> r, float n)
+    {
+        return fOpDifferenceColumns(a, -b, r, n);
+    }
+
+    // The "Stairs" flavour produces n-1 steps of a staircase:
+    // much less stupid version by paniq
+    template<typename T>
+    constexpr T fOpUnionStairs(T a, same_t<T> b, same_t<T> r, float n)
+    {
+        T s = r / T(n);
+        T u = b - r;
+        return min(min(a, b), T(0.5) * (u + a + abs((mod(u - a + s, T(2) * s)) - s)));
+    }
+
+    // We can just call Union since stairs are symmetric.
+    template<typename T>
+    constexpr T fOpIntersectionStairs(T a, same_t<T> b, same_t<T> r, float n)
+    {
+        return -fOpUnionStairs(-a, -b, r, n);
+    }
+
+    template<typename T>
+    constexpr T fOpDifferenceStairs(T a, same_t<T> b, same_t<T> r, float n)
+    {
+        return -fOpUnionStairs(-a, b, r, n);
+    }
+
+    // Similar to fOpUnionRound, but more lipschitz-y at acute angles
+    // (and less so at 90 degrees). Useful when fudging around too much
+    // by MediaMolecule, from Alex Evans' siggraph slides
+    template<typename T>
+    constexpr T fOpUnionSoft(T a, same_t<T> b, same_t<T> r)
+    {
+        T e = max(r - abs(a - b), T(0));
+        return min(a, b) - e * e * T(0.25) / r;
+    }
+
+    // produces a cylindical pipe that runs along the intersection.
+    // No objects remain, only the pipe. This is not a boolean operator.
+    template<typename T>
+    constexpr T fOpPipe(T a, same_t<T> b, same_t<T> r)
+    {
+        return length(vec2<T>(a, b)) - r;
+    }
+
+    // first object gets a v-shaped engraving where it intersect the second
+    template<typename T>
+    constexpr T fOpEngrave(T a, same_t<T> b, same_t<T> r)
+    {
+        return max(a, (a + r - abs(b)) * T(SQRT_HALF));
+    }
+
+    // first object gets a capenter-style groove cut out
+    template<typename T>
+    constexpr T fOpGroove(T a, same_t<T> b, same_t<T> ra, same_t<T> rb)
+    {
+        return max(a, min(a + ra, rb - abs(b)));
+    }
+
+    // first object gets a capenter-style tongue attached
+    template<typename T>
+    constexpr T fOpTongue(T a, same_t<T> b, same_t<T> ra, same_t<T> rb)
+    {
+        return min(a, max(a - ra, abs(b) - rb));
+    }
+}
+
+#endif
@@ -15,12 +15,32 @@
 #include "Utilities.h"
 #include "Shader.h"
 #include "Camera.h"
+#include "Framebuffer.h"
+#include "AsyncReadback.h"
+#include "FrameConstants.h"
+#include "CameraPath.h"
+#include "BenchmarkReport.h"
+#include "GpuProfiler.h"
+#include "StepStatistics.h"
+#include "ConePrepass.h"
+#include "Heightmap.h"
+#include "DeferredPipeline.h"
+#include "TemporalAA.h"
+#include "DynamicResolution.h"
+#include "Checkerboard.h"
+#include "HeadlessContext.h"
+#include "ImageIO.h"
+#include "CpuRenderer.h"
 
 
 //Utility Headers
 #include <iostream>
 #include <vector>
 #include <memory>
+#include <string>
+#include <chrono>
+#include <cstdlib>
+#include <cmath>
 
 
 //Camera
@@ -33,6 +53,301 @@ double lastFrame = 0.0;
 //Window
 GLFWwindow* window;
 
+/*
+    Command line options.
+ 
+    Without arguments the interactive window is opened.
+    "--headless" renders the scenes into an offscreen framebuffer instead; no window,
+    display server or vsync is involved, so batch throughput is bound by the GPU only.
+    "--benchmark" replays a camera path offscreen with a fixed clock and reports frame times.
+*/
+struct AppOptions
+{
+    bool headless = false;
+    //Render with the CPU ray marcher instead of OpenGL
+    bool cpu = false;
+    //CPU worker threads, 0 means one per hardware thread
+    int threads = 0;
+    int width = SCR_WIDTH;
+    int height = SCR_HEIGHT;
+    int frames = 1;
+    bool framesGiven = false;
+    //Simulated seconds between two headless frames, drives the "time" uniform
+    double timeStep = 1.0 / 60.0;
+    std::string sceneName = "all";
+    std::string outputDir = ".";
+    bool writeImages = true;
+    //Linked program binaries, empty disables the cache
+    std::string shaderCacheDir = "shader_cache";
+    //Frame time measurement over a replayed camera path
+    bool benchmark = false;
+    int warmupFrames = 30;
+    std::string reportName = "benchmark";
+    //Replayed by the benchmark, the default fly-through is used if empty
+    std::string cameraPathFile;
+    //The interactive camera movement is saved here on exit
+    std::string recordPathFile;
+    //Step count heatmap (debug_mode in Shaders/step_debug.glsl), 0 renders the shaded image
+    int debugMode = 0;
+    //Over-relaxation factor of the primary march for every scene, 0 keeps the per scene defaults
+    float relaxation = 0.0f;
+    //Surface normal estimator for every scene (normal_estimator in Shaders/normals.glsl), -1 keeps the per scene defaults
+    int normalEstimator = -1;
+    //Primary rays over the terrain marched as a heightfield instead of sphere traced (heightfield_march in scene3)
+    bool heightfieldMarch = true;
+    //Level of detail bias of the procedural noise for every scene (lod_bias in Shaders/lod.glsl), negative keeps the per scene defaults
+    float lodBias = -1.0f;
+    //Bake the min/max heightmap pyramid of the heightfield scenes and skip the space above it
+    bool heightmap = true;
+    //Hierarchical cone marching prepass that finds the start distances of the primary rays
+    bool conePrepass = true;
+    //Separate G-buffer, shadow, ambient occlusion and shading passes instead of one pass per scene
+    bool deferred = true;
+    //Shadow and AO resolution divisor of the deferred pipeline (1, 2 or 4), 0 keeps the per scene defaults
+    int lightingScale = 0;
+    //Start the primary rays of the deferred pipeline at last frame's reprojected hits
+    bool temporalCache = true;
+    //Temporal anti-aliasing of the deferred pipeline: jittered rays blended into a reprojected history
+    bool taa = false;
+    //GPU frame time in milliseconds the interactive mode scales its render resolution to hold, 0 renders at the window size
+    double frameBudget = 0.0;
+    //March half of the pixels per frame in the single pass shaders and reconstruct the others
+    bool checkerboard = false;
+};
+
+//Names of the debug modes, the index is the value of the debug_mode uniform
+static const char* DEBUG_MODE_NAMES[] = { "off", "primary", "shadow", "ao", "total" };
+static constexpr int DEBUG_MODE_COUNT = 5;
+
+//Values of the normal_estimator uniform, the NORMAL_* constants of Shaders/normals.glsl
+enum NormalEstimator
+{
+    NORMAL_CENTRAL = 0,
+    NORMAL_TETRAHEDRAL = 1,
+    NORMAL_FORWARD = 2,
+    NORMAL_ANALYTIC = 3,
+    NORMAL_ESTIMATOR_COUNT
+};
+
+//Names of the normal estimators, indexed by NormalEstimator
+static const char* NORMAL_ESTIMATOR_NAMES[] = { "central", "tetrahedral", "forward", "analytic" };
+static_assert(sizeof(NORMAL_ESTIMATOR_NAMES) / sizeof(NORMAL_ESTIMATOR_NAMES[0]) == NORMAL_ESTIMATOR_COUNT,
+              "NORMAL_ESTIMATOR_NAMES needs a name per NormalEstimator");
+
+/*
+    Over-relaxation factor of the primary march per scene (1.0 is plain sphere tracing).
+    The building and the terrain are mostly open space in front of large surfaces, relaxed steps
+    let the grazing rays over the terrain reach the horizon within MAX_STEPS.
+    The sponge is full of thin features where nearly every relaxed step would overshoot.
+*/
+float sceneRelaxation(const std::string& sceneName, const AppOptions& options)
+{
+    if (options.relaxation > 0.0f)
+        return options.relaxation;
+    if (sceneName == "building")
+        return 1.6f;
+    if (sceneName == "terrain")
+        return 1.5f;
+    return 1.0f;
+}
+
+/*
+    Normal estimator per scene, a NormalEstimator.
+    The terrain heightfield has a closed form gradient, which is exact and costs no extra distance evaluations.
+    The other scenes use tetrahedral differences, 4 evaluations instead of the 6 of central differences.
+*/
+int sceneNormalEstimator(const std::string& sceneName, const AppOptions& options)
+{
+    if (options.normalEstimator >= 0)
+        return options.normalEstimator;
+    if (sceneName == "terrain")
+        return NORMAL_ANALYTIC;
+    return NORMAL_TETRAHEDRAL;
+}
+
+/*
+    Level of detail bias of the procedural noise per scene, the footprint of a pixel is scaled by it
+    before the octaves it cannot resolve are dropped. Only the terrain is built from noise octaves,
+    at 1.0 they fade out as their cells shrink from four to two pixels. The other scenes keep full detail.
+*/
+float sceneLodBias(const std::string& sceneName, const AppOptions& options)
+{
+    if (options.lodBias >= 0.0f)
+        return options.lodBias;
+    if (sceneName == "terrain")
+        return 1.0f;
+    return 0.0f;
+}
+
+/*
+    Pixels per texel side of the shadow and AO targets of the deferred pipeline per scene.
+    The sponge is lit by broad soft terms that survive 1/4 resolution. The shadows of the building
+    and the terrain have sharp edges and small occluders that 1/4 resolution visibly widens.
+*/
+int sceneLightingScale(const std::string& sceneName, const AppOptions& options)
+{
+    if (options.lightingScale > 0)
+        return options.lightingScale;
+    if (sceneName == "fractal")
+        return 4;
+    return 2;
+}
+
+void printUsage(const char* program)
+{
+    std::cout << "Usage: " << program << " [options]\n"
+              << "  --headless          render offscreen without opening a window\n"
+              << "  --cpu               render with the CPU ray marcher, no OpenGL needed\n"
+              << "  --threads N         CPU worker threads (default: all hardware threads)\n"
+              << "  --width N           offscreen width (default " << SCR_WIDTH << ")\n"
+              << "  --height N          offscreen height (default " << SCR_HEIGHT << ")\n"
+              << "  --frames N          frames to render per scene (default 1, benchmark 300)\n"
+              << "  --dt SECONDS        simulated time between frames (default 1/60)\n"
+              << "  --scene NAME        building, fractal, terrain, tile or all (default all)\n"
+              << "  --output DIR        directory for the rendered images (default .)\n"
+              << "  --no-output         render and read back but do not write images\n"
+              << "  --shader-cache DIR  directory for cached program binaries (default shader_cache)\n"
+              << "  --no-shader-cache   always compile the shaders from source\n"
+              << "  --benchmark         replay a camera path offscreen and report frame times\n"
+              << "  --camera-path FILE  camera path replayed by the benchmark (default: built-in fly-through)\n"
+              << "  --warmup N          unmeasured frames before each benchmarked scene (default 30)\n"
+              << "  --report NAME       benchmark results go to NAME.csv and NAME.json in the output directory\n"
+              << "  --record-path FILE  save the interactive camera movement as a camera path\n"
+              << "  --relaxation W      over-relaxation factor of the primary march, 1 disables it (default per scene)\n"
+              << "  --normals MODE      normal estimator: central, tetrahedral, forward or analytic (default per scene)\n"
+              << "  --lod-bias B        pixels per footprint the noise octaves are dropped at, 0 disables the LOD (default per scene)\n"
+              << "  --no-heightfield    sphere trace the terrain instead of marching it as a heightfield\n"
+              << "  --no-heightmap      march the terrain without its baked min/max heightmap\n"
+              << "  --no-cone-prepass   march every primary ray from the camera\n"
+              << "  --forward           render each scene in a single pass instead of the deferred pipeline\n"
+              << "  --no-temporal-cache march the primary rays without last frame's hit distances\n"
+              << "  --taa               temporal anti-aliasing, needs the deferred pipeline\n"
+              << "  --dynamic-resolution MS  scale the interactive render resolution to hold MS of GPU time per frame\n"
+              << "  --checkerboard      march every other pixel per frame in a single pass, reconstruct the rest\n"
+              << "  --lighting-scale N  trace deferred shadows and AO at 1/N resolution, N is 1, 2 or 4 (default per scene)\n"
+              << "  --debug-steps MODE  step count heatmap: primary, shadow, ao or total. Headless runs also\n"
+              << "                      write step histograms (<scene>_steps.csv)" << std::endl;
+}
+
+bool parseArguments(int argc, char** argv, AppOptions& options)
+{
+    for (int i = 1; i < argc; ++i)
+    {
+        std::string arg = argv[i];
+        bool hasValue = (i + 1 < argc);
+        if (arg == "--headless")
+            options.headless = true;
+        else if (arg == "--cpu")
+            options.cpu = true;
+        else if (arg == "--threads" && hasValue)
+            options.threads = std::atoi(argv[++i]);
+        else if (arg == "--no-output")
+            options.writeImages = false;
+        else if (arg == "--width" && hasValue)
+            options.width = std::atoi(argv[++i]);
+        else if (arg == "--height" && hasValue)
+            options.height = std::atoi(argv[++i]);
+        else if (arg == "--frames" && hasValue)
+        {
+            options.frames = std::atoi(argv[++i]);
+            options.framesGiven = true;
+        }
+        else if (arg == "--dt" && hasValue)
+            options.timeStep = std::atof(argv[++i]);
+        else if (arg == "--scene" && hasValue)
+            options.sceneName = argv[++i];
+        else if (arg == "--output" && hasValue)
+            options.outputDir = argv[++i];
+        else if (arg == "--shader-cache" && hasValue)
+            options.shaderCacheDir = argv[++i];
+        else if (arg == "--no-shader-cache")
+            options.shaderCacheDir.clear();
+        else if (arg == "--benchmark")
+            options.benchmark = true;
+        else if (arg == "--camera-path" && hasValue)
+            options.cameraPathFile = argv[++i];
+        else if (arg == "--warmup" && hasValue)
+            options.warmupFrames = std::max(std::atoi(argv[++i]), 0);
+        else if (arg == "--report" && hasValue)
+            options.reportName = argv[++i];
+        else if (arg == "--record-path" && hasValue)
+            options.recordPathFile = argv[++i];
+        else if (arg == "--relaxation" && hasValue)
+            options.relaxation = (float)std::atof(argv[++i]);
+        else if (arg == "--normals" && hasValue)
+        {
+            std::string name = argv[++i];
+            options.normalEstimator = -1;
+            for (int mode = 0; mode < NORMAL_ESTIMATOR_COUNT; ++mode)
+            {
+                if (name == NORMAL_ESTIMATOR_NAMES[mode])
+                    options.normalEstimator = mode;
+            }
+            if (options.normalEstimator < 0)
+            {
+                printUsage(argv[0]);
+                return false;
+            }
+        }
+        else if (arg == "--lod-bias" && hasValue)
+            options.lodBias = (float)std::atof(argv[++i]);
+        else if (arg == "--no-heightfield")
+            options.heightfieldMarch = false;
+        else if (arg == "--no-heightmap")
+            options.heightmap = false;
+        else if (arg == "--no-cone-prepass")
+            options.conePrepass = false;
+        else if (arg == "--forward")
+            options.deferred = false;
+        else if (arg == "--no-temporal-cache")
+            options.temporalCache = false;
+        else if (arg == "--taa")
+            options.taa = true;
+        else if (arg == "--checkerboard")
+            options.checkerboard = true;
+        else if (arg == "--dynamic-resolution" && hasValue)
+            options.frameBudget = std::max(std::atof(argv[++i]), 0.0);
+        else if (arg == "--lighting-scale" && hasValue)
+        {
+            options.lightingScale = std::atoi(argv[++i]);
+            if (options.lightingScale != 1 && options.lightingScale != 2 && options.lightingScale != 4)
+            {
+                printUsage(argv[0]);
+                return false;
+            }
+        }
+        else if (arg == "--debug-steps" && hasValue)
+        {
+            std::string mode = argv[++i];
+            options.debugMode = -1;
+            for (int m = 1; m < DEBUG_MODE_COUNT; ++m)
+            {
+                if (mode == DEBUG_MODE_NAMES[m])
+                    options.debugMode = m;
+            }
+            if (options.debugMode < 0)
+            {
+                printUsage(argv[0]);
+                return false;
+            }
+        }
+        else
+        {
+            printUsage(argv[0]);
+            return false;
+        }
+    }
+
+    if (options.benchmark && !options.framesGiven)
+        options.frames = 300;
+    if (options.width <= 0 || options.height <= 0 || options.frames <= 0)
+    {
+        std::cout << "Width, height and frame count must be positive" << std::endl;
+        return false;
+    }
+    return true;
+}
+
 
 //Texture Loader
 GLuint textureFromFile(const char* filePath, bool verticalFlip)
@@ -81,34 +396,130 @@ GLuint textureFromFile(const char* filePath, bool verticalFlip)
 /*
     Struct representing each scene. It contains a shader and textures.
     It is responsible for binding its textures.
+    The deferred programs are only built if setDeferredShaders is called.
  
     Texture Naming Convention:
     To create a general struct we follow the following naming convention
     texture + index (index starting from 0 to n-1 for n textures)
+    The sampler uniforms never change, they are assigned once when the textures are loaded.
 */
 struct Scene
 {
+    std::string name;
     Shader shader;
+    DeferredPipeline::Programs deferred;
     std::vector<GLuint> textures;
+    Uniform<int> debugMode;
+    Uniform<float> relaxation;
+    Uniform<int> normalEstimator;
+    Uniform<int> heightfieldMarch;
+    Uniform<float> lodBias;
+    Uniform<int> checkerboardField;
+    ConePrepass::Uniforms conePrepass;
+    Heightmap heightmap;
+    Heightmap::Uniforms heightmapUniforms;
+    //Shadow and AO resolution divisor when the scene is rendered by the deferred pipeline
+    int lightingScale = 1;
+    void setShader(const Shader& shader_in)
+    {
+        shader = shader_in;
+        //Camera, time and resolution come from the shared frame constants buffer
+        shader.bindUniformBlock(FrameConstantsBuffer::BLOCK_NAME, FrameConstantsBuffer::BINDING);
+        debugMode = shader.uniform<int>("debug_mode");
+        relaxation = shader.uniform<float>("relaxation");
+        normalEstimator = shader.uniform<int>("normal_estimator");
+        heightfieldMarch = shader.uniform<int>("heightfield_march");
+        lodBias = shader.uniform<float>("lod_bias");
+        checkerboardField = shader.uniform<int>("checkerboard_field");
+        conePrepass.resolve(shader);
+        heightmapUniforms.resolve(shader);
+    }
+
+    void setDeferredShaders(const char* vertexPath, const char* fragmentPath)
+    {
+        deferred.build(vertexPath, fragmentPath);
+    }
+
+    void setRelaxation(float omega) const
+    {
+        shader.use();
+        relaxation.set(omega);
+        if (deferred.isValid())
+            deferred.setRelaxation(omega);
+    }
+
+    void setNormalEstimator(int estimator) const
+    {
+        shader.use();
+        normalEstimator.set(estimator);
+        if (deferred.isValid())
+            deferred.setNormalEstimator(estimator);
+    }
+
+    //Only the terrain has a heightfield marcher, the uniform is inactive in the other scenes
+    void setHeightfieldMarch(bool enabled) const
+    {
+        shader.use();
+        heightfieldMarch.set(enabled ? 1 : 0);
+        if (deferred.isValid())
+            deferred.setHeightfieldMarch(enabled);
+    }
+
+    void setLodBias(float bias) const
+    {
+        shader.use();
+        lodBias.set(bias);
+        if (deferred.isValid())
+            deferred.setLodBias(bias);
+    }
+
+    //Scenes whose shader bounds its heightfield bake the heightmap pyramid once, the others skip it
+    void bakeHeightmap(GLuint quad)
+    {
+        if (!heightmapUniforms.isActive())
+            return;
+        heightmap.bake(shader, heightmapUniforms, quad);
+        heightmap.enable(shader, heightmapUniforms);
+        if (deferred.isValid())
+            heightmap.enable(deferred.stages[DeferredPipeline::GBUFFER], deferred.heightmap);
+    }
+
+    void setDebugMode(int mode) const
+    {
+        shader.use();
+        debugMode.set(mode);
+    }
+
+    //0 marches every pixel, see Checkerboard::getField
+    void setCheckerboardField(int field) const
+    {
+        shader.use();
+        checkerboardField.set(field);
+    }
+
     void loadTextures(const std::vector<const char*>& texturePaths)
     {
-        for(int i = 0; i < texturePaths.size(); ++i)
+        for(int i = 0; i < (int)texturePaths.size(); ++i)
         {
             textures.push_back(textureFromFile(texturePaths[i], false));
+            //Texture unit i
+            shader.use();
+            shader.uniform<int>("texture" + std::to_string(i)).set(i);
+            if (deferred.isValid())
+                deferred.setTextureUnit("texture" + std::to_string(i), i);
         }
     }
     
-    void bindTextures()
+    void bindTextures() const
     {
-        for(int i = 0; i < textures.size(); ++i)
+        for(int i = 0; i < (int)textures.size(); ++i)
         {
             //Activate and bind to the corresponding texture location
             glActiveTexture(GL_TEXTURE0 + i);
             glBindTexture(GL_TEXTURE_2D, textures[i]);
-            //Set the uniform
-            std::string texture_name = "texture" + std::to_string(i);
-            shader.setInt(texture_name, i);
         }
+        if (heightmap.isBaked())
+            heightmap.bind();
     }
 };
 
@@ -224,6 +635,33 @@ int setupDependencies()
 	return 0;
 }
 
+//Creates a windowless context for the headless mode
+int setupHeadless(HeadlessContext& context)
+{
+    if (!context.create(4, 1))
+    {
+        std::cout << "Failed to create the headless context" << std::endl;
+        return -1;
+    }
+
+    glewExperimental = GL_TRUE;
+    GLenum status = glewInit();
+    //GLEW also probes GLX which fails without an X display, the GL entry points are loaded regardless
+#ifdef GLEW_ERROR_NO_GLX_DISPLAY
+    if (status == GLEW_ERROR_NO_GLX_DISPLAY)
+        status = GLEW_OK;
+#endif
+    if (status != GLEW_OK)
+    {
+        std::cout << "Failed to initialize GLEW" << std::endl;
+        return -1;
+    }
+
+    //Configure Global OpenGL State
+    glEnable(GL_DEPTH_TEST);
+    return 0;
+}
+
 GLuint screenSizeQuad()
 {
     GLfloat vertices[] =
@@ -267,40 +705,419 @@ GLuint screenSizeQuad()
     return VAO;
 }
 
-void renderScreenSizeQuad(GLuint VAO, Shader shader)
+//Per frame values of every scene, written to the frame constants buffer once per frame
+FrameConstantsBlock frameConstants(glm::vec2 resolution, float time, glm::vec2 jitter = glm::vec2(0.0f))
+{
+    FrameConstantsBlock constants = {};
+    constants.cameraPos = camera.getPosition();
+    constants.time = time;
+    constants.front = camera.getFront();
+    constants.right = camera.getRight();
+    constants.up = camera.getUp();
+    constants.resolution = resolution;
+    constants.jitter = jitter;
+    return constants;
+}
+
+void renderScreenSizeQuad(GLuint VAO, const Scene& scene)
 {
-    shader.use();
-    glm::vec3 camPos = camera.getPosition();
-    //Uniforms
-    shader.setVec2("resolution", glm::vec2(SCR_WIDTH, SCR_HEIGHT));
-    shader.setVec3("camera_pos", camPos);
-    shader.setVec3("front", camera.getFront());
-    shader.setVec3("right", camera.getRight());
-    shader.setVec3("up", camera.getUp());
-    shader.setFloat("time", glfwGetTime());
+    scene.shader.use();
     glBindVertexArray(VAO);
     //total 6 indices since we have triangles
     glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0);
 
 }
 
+/*
+    Offscreen passes in front of the final draw of a scene, sized for one output resolution.
+    Scenes whose deferred programs are missing or failed to build render in a single pass.
+*/
+struct ScenePasses
+{
+    ConePrepass conePrepass;
+    DeferredPipeline deferred;
+    bool useConePrepass = true;
+    bool useDeferred = true;
+    bool useTemporalCache = true;
+    TemporalAA taa;
+    bool useTaa = false;
+    //Scene of the TAA history, nullptr if there is none
+    const Scene* taaScene = nullptr;
+    Checkerboard checkerboard;
+    bool useCheckerboard = false;
+    const Scene* checkerboardScene = nullptr;
+
+    void create(int width, int height)
+    {
+        conePrepass.create(width, height);
+        if (useDeferred)
+            deferred.create(width, height);
+        if (useTaa)
+            taa.create(width, height);
+        if (useCheckerboard)
+            checkerboard.create(width, height);
+    }
+
+    //Keeps what create() allocated, at another output size
+    void resize(int width, int height)
+    {
+        conePrepass.resize(width, height);
+        if (deferred.getWidth() > 0)
+            deferred.resize(width, height);
+        if (taa.getWidth() > 0)
+            taa.resize(width, height);
+        if (checkerboard.getWidth() > 0)
+            checkerboard.resize(width, height);
+    }
+
+    //Checkerboard frames are rendered by the single pass shader, even if the deferred pipeline is on
+    bool isCheckerboardActive() const
+    {
+        return useCheckerboard && checkerboard.getWidth() > 0;
+    }
+
+    //The resolve reprojects with the G-buffer, so TAA only runs with the deferred pipeline
+    bool isTaaActive(const Scene& scene) const
+    {
+        return useTaa && useDeferred && !isCheckerboardActive() && scene.deferred.isValid() && taa.getWidth() > 0;
+    }
+
+    //Subpixel offset of the primary rays for the frame constants of the next frame
+    glm::vec2 jitter(const Scene& scene) const
+    {
+        return isTaaActive(scene) ? taa.getJitter() : glm::vec2(0.0f);
+    }
+
+    void release()
+    {
+        conePrepass.release();
+        deferred.release();
+        taa.release();
+        checkerboard.release();
+    }
+};
 
-int main()
+/*
+    Renders one frame of the scene into target (the window if it is null), which is cleared first.
+    The frame constants of the frame have to be written already, with passes.jitter(scene).
+*/
+void renderScene(GLuint VAO, const Scene& scene, ScenePasses& passes, const Framebuffer* target, int width, int height, GpuProfiler& profiler)
 {
-	setupDependencies();
-    
-    GLuint quad = screenSizeQuad();
-    Scene scene, buildingScene,fractalScene,terrainScene,tileScene;
-    
-    buildingScene.shader = Shader("Shaders/scene1/scene1_vertex.glsl",
-                           "Shaders/scene1/scene1_fragment.glsl");
-    fractalScene.shader = Shader("Shaders/scene2/scene2_vertex.glsl",
-                           "Shaders/scene2/scene2_fragment.glsl");
-    terrainScene.shader = Shader("Shaders/scene3/scene3_vertex.glsl",
-                           "Shaders/scene3/scene3_fragment.glsl");
-    tileScene.shader = Shader("Shaders/scene4/scene4_vertex.glsl",
-                           "Shaders/scene4/scene4_fragment.glsl");
-    
+    scene.bindTextures();
+    bool checkerboard = passes.isCheckerboardActive();
+    bool deferred = passes.useDeferred && !checkerboard && scene.deferred.isValid();
+
+    //Start distances for the primary rays of the program that marches them
+    const Shader& marchShader = deferred ? scene.deferred.stages[DeferredPipeline::GBUFFER] : scene.shader;
+    const ConePrepass::Uniforms& coneUniforms = deferred ? scene.deferred.conePrepass : scene.conePrepass;
+    if (passes.useConePrepass)
+    {
+        GpuProfiler::Scope pass(profiler, "cone prepass");
+        passes.conePrepass.render(marchShader, coneUniforms, VAO);
+    }
+    else
+    {
+        ConePrepass::disable(marchShader, coneUniforms);
+    }
+    if (deferred)
+    {
+        passes.deferred.setTemporalCache(passes.useTemporalCache);
+        passes.deferred.setLightingScale(scene.lightingScale);
+        passes.deferred.renderLighting(scene.deferred, VAO, profiler);
+    }
+
+    //With TAA the scene is shaded into its target and resolved into the caller's one
+    bool taa = passes.isTaaActive(scene);
+    if (!taa || passes.taaScene != &scene)
+        passes.taa.resetHistory();
+    passes.taaScene = taa ? &scene : nullptr;
+    //The checkerboard marches one field into its target and reconstructs the image into the caller's one
+    if (!checkerboard || passes.checkerboardScene != &scene)
+        passes.checkerboard.resetHistory();
+    passes.checkerboardScene = checkerboard ? &scene : nullptr;
+
+    if (taa)
+        passes.taa.getSceneTarget().bind();
+    else if (checkerboard)
+        passes.checkerboard.getFieldTarget().bind();
+    else if (target != nullptr)
+        target->bind();
+    else
+        Framebuffer::bindDefault(width, height);
+    glClearColor(0.1f, 0.1f, 0.1f, 1.0f);
+    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+    if (deferred)
+    {
+        passes.deferred.renderShading(scene.deferred, VAO, profiler);
+        if (taa)
+            passes.taa.resolve(VAO, target, profiler);
+    }
+    else
+    {
+        {
+            GpuProfiler::Scope pass(profiler, scene.name);
+            scene.setCheckerboardField(checkerboard ? passes.checkerboard.getField() : 0);
+            renderScreenSizeQuad(VAO, scene);
+        }
+        if (checkerboard)
+            passes.checkerboard.reconstruct(VAO, target, profiler);
+        //The G-buffer of an earlier frame no longer matches the previous camera
+        passes.deferred.resetHistory();
+    }
+}
+
+/*
+    Renders every selected scene into an offscreen framebuffer and reads the frames back asynchronously.
+    The readback ring keeps a few frames in flight so the CPU never waits for the copy of the frame it just submitted.
+*/
+int renderHeadless(GLuint quad, const std::vector<Scene*>& scenes, FrameConstantsBuffer& constantsBuffer, GpuProfiler& profiler, const AppOptions& options)
+{
+    //In a debug mode the scenes also write their raw step counts to a second attachment
+    bool collectSteps = (options.debugMode != 0);
+    std::vector<GLenum> colorFormats = {GL_RGBA8};
+    if (collectSteps)
+        colorFormats.push_back(GL_RGBA32F);
+    Framebuffer target(options.width, options.height, colorFormats);
+    //The step counters are per pass, the heatmap needs the single pass shaders
+    ScenePasses passes;
+    passes.useConePrepass = options.conePrepass;
+    passes.useTemporalCache = options.temporalCache;
+    passes.useDeferred = options.deferred && !collectSteps;
+    passes.useTaa = options.taa;
+    passes.useCheckerboard = options.checkerboard && !collectSteps;
+    passes.create(options.width, options.height);
+    AsyncReadback readback(3);
+    AsyncReadback stepReadback(collectSteps ? 3 : 0);
+    std::vector<StepStatistics> stepStatistics(scenes.size());
+
+    //Tags encode (scene, frame) so finished transfers can be named after the frame they belong to
+    auto onFrameRead = [&](int tag, const void* pixels, int width, int height)
+    {
+        if (!options.writeImages)
+            return;
+        const Scene& scene = *scenes[tag / options.frames];
+        std::string path = options.outputDir + "/" + scene.name + "_" + std::to_string(tag % options.frames) + ".ppm";
+        writePPM(path, (const unsigned char*)pixels, width, height, 4, true);
+    };
+    auto onStepsRead = [&](int tag, const void* pixels, int width, int height)
+    {
+        stepStatistics[tag / options.frames].accumulate((const float*)pixels, width, height);
+    };
+
+    int renderedFrames = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (int s = 0; s < (int)scenes.size(); ++s)
+    {
+        Scene& scene = *scenes[s];
+        if (options.sceneName != "all" && options.sceneName != scene.name)
+            continue;
+        if (!scene.shader.isValid())
+        {
+            std::cout << "Skipping scene " << scene.name << ", its shader is not valid" << std::endl;
+            continue;
+        }
+
+        scene.setDebugMode(options.debugMode);
+        for (int frame = 0; frame < options.frames; ++frame)
+        {
+            profiler.beginFrame();
+            constantsBuffer.update(frameConstants(glm::vec2(options.width, options.height), (float)(frame * options.timeStep), passes.jitter(scene)));
+            renderScene(quad, scene, passes, &target, options.width, options.height, profiler);
+            constantsBuffer.endFrame();
+
+            //Only block when every slot is in flight, i.e. the GPU is a full ring behind
+            int tag = s * options.frames + frame;
+            {
+                GpuProfiler::Scope pass(profiler, "readback");
+                while (!readback.request(target, 0, GL_RGBA, GL_UNSIGNED_BYTE, tag))
+                {
+                    readback.poll(onFrameRead, true);
+                }
+                while (collectSteps && !stepReadback.request(target, 1, GL_RGBA, GL_FLOAT, tag))
+                {
+                    stepReadback.poll(onStepsRead, true);
+                }
+            }
+            profiler.endFrame();
+            readback.poll(onFrameRead);
+            stepReadback.poll(onStepsRead);
+            ++renderedFrames;
+        }
+    }
+    readback.flush(onFrameRead);
+    stepReadback.flush(onStepsRead);
+
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    std::cout << "Rendered " << renderedFrames << " frames at " << options.width << "x" << options.height
+              << " in " << elapsed.count() << " s (" << renderedFrames / elapsed.count() << " frames/s)" << std::endl;
+    profiler.print(std::cout);
+    for (int s = 0; s < (int)scenes.size(); ++s)
+    {
+        if (stepStatistics[s].getPixelCount() == 0)
+            continue;
+        stepStatistics[s].print(std::cout, scenes[s]->name);
+        if (options.writeImages)
+            stepStatistics[s].writeCSV(options.outputDir + "/" + scenes[s]->name + "_steps.csv");
+    }
+
+    readback.release();
+    stepReadback.release();
+    passes.release();
+    target.release();
+    return renderedFrames > 0 ? 0 : -1;
+}
+
+/*
+    Replays the camera path in every selected scene with a fixed clock and measures each frame.
+
+    Frames are finished one by one (glFinish) so the wall time of a frame is its full latency and
+    the GL_TIME_ELAPSED query around it can be read right away; throughput is what --headless measures.
+    The first --warmup frames of a scene are rendered at the start pose and discarded.
+*/
+int runBenchmark(GLuint quad, const std::vector<Scene*>& scenes, FrameConstantsBuffer& constantsBuffer, GpuProfiler& profiler, const AppOptions& options)
+{
+    CameraPath path;
+    if (!options.cameraPathFile.empty())
+    {
+        if (!path.load(options.cameraPathFile))
+            return -1;
+    }
+    else
+    {
+        path = CameraPath::defaultPath((float)(options.frames * options.timeStep));
+    }
+    float pathStart = path.getKeyframes().front().time;
+
+    Framebuffer target(options.width, options.height);
+    ScenePasses passes;
+    passes.useConePrepass = options.conePrepass;
+    passes.useTemporalCache = options.temporalCache;
+    passes.useDeferred = options.deferred;
+    passes.useTaa = options.taa;
+    passes.useCheckerboard = options.checkerboard;
+    passes.create(options.width, options.height);
+    GLuint query;
+    glGenQueries(1, &query);
+
+    BenchmarkReport report;
+    report.renderer = (const char*)glGetString(GL_RENDERER);
+    report.version = (const char*)glGetString(GL_VERSION);
+    report.cameraPath = options.cameraPathFile.empty() ? "default" : options.cameraPathFile;
+    report.timeStep = options.timeStep;
+    report.warmupFrames = options.warmupFrames;
+
+    for (Scene* scenePointer : scenes)
+    {
+        Scene& scene = *scenePointer;
+        if (options.sceneName != "all" && options.sceneName != scene.name)
+            continue;
+        if (!scene.shader.isValid())
+        {
+            std::cout << "Skipping scene " << scene.name << ", its shader is not valid" << std::endl;
+            continue;
+        }
+
+        SceneBenchmark result;
+        result.scene = scene.name;
+        result.width = options.width;
+        result.height = options.height;
+        for (int frame = -options.warmupFrames; frame < options.frames; ++frame)
+        {
+            float time = (float)(std::max(frame, 0) * options.timeStep);
+            path.apply(camera, pathStart + time);
+
+            auto begin = std::chrono::steady_clock::now();
+            glBeginQuery(GL_TIME_ELAPSED, query);
+            constantsBuffer.update(frameConstants(glm::vec2(options.width, options.height), time, passes.jitter(scene)));
+            renderScene(quad, scene, passes, &target, options.width, options.height, profiler);
+            constantsBuffer.endFrame();
+            glEndQuery(GL_TIME_ELAPSED);
+            glFinish();
+            std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - begin;
+
+            if (frame < 0)
+                continue;
+            GLuint64 gpuNanoseconds = 0;
+            glGetQueryObjectui64v(query, GL_QUERY_RESULT, &gpuNanoseconds);
+            result.frameTimes.push_back(elapsed.count());
+            result.gpuTimes.push_back(gpuNanoseconds * 1e-6);
+        }
+        result.frame = FrameTimeStats::compute(result.frameTimes);
+        result.gpu = FrameTimeStats::compute(result.gpuTimes);
+        report.scenes.push_back(result);
+    }
+
+    glDeleteQueries(1, &query);
+    passes.release();
+    target.release();
+
+    report.print();
+    if (options.writeImages)
+    {
+        report.writeCSV(options.outputDir + "/" + options.reportName + ".csv");
+        report.writeJSON(options.outputDir + "/" + options.reportName + ".json");
+    }
+    return report.scenes.empty() ? -1 : 0;
+}
+
+
+//Name and textures of a scene, the CPU versions load their textures themselves
+struct CpuSceneSource
+{
+    std::string name;
+    std::vector<const char*> texturePaths;
+};
+
+/*
+    Renders the selected scenes with the CPU reference marcher.
+    Images are named "<scene>_cpu_<frame>.ppm" so they can be compared with the headless GL output.
+*/
+int renderCpu(const std::vector<CpuSceneSource>& sources, const AppOptions& options)
+{
+    CpuRenderer renderer(options.threads);
+    std::vector<unsigned char> pixels;
+
+    int renderedFrames = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (const CpuSceneSource& source : sources)
+    {
+        if (options.sceneName != "all" && options.sceneName != source.name)
+            continue;
+        std::unique_ptr<CpuScene> scene = createCpuScene(source.name, source.texturePaths);
+        if (scene == nullptr)
+        {
+            std::cout << "Skipping scene " << source.name << ", it has no CPU version" << std::endl;
+            continue;
+        }
+        scene->setRelaxation(sceneRelaxation(source.name, options));
+
+        for (int frame = 0; frame < options.frames; ++frame)
+        {
+            scene->setTime((float)(frame * options.timeStep));
+            renderer.render(*scene, camera, options.width, options.height, pixels);
+            if (options.writeImages)
+            {
+                std::string path = options.outputDir + "/" + source.name + "_cpu_" + std::to_string(frame) + ".ppm";
+                writePPM(path, pixels.data(), options.width, options.height, 3, false);
+            }
+            ++renderedFrames;
+        }
+    }
+
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    std::cout << "Rendered " << renderedFrames << " frames at " << options.width << "x" << options.height
+              << " on " << renderer.getThreadCount() << " threads in " << elapsed.count() << " s ("
+              << renderedFrames / elapsed.count() << " frames/s)" << std::endl;
+    return renderedFrames > 0 ? 0 : -1;
+}
+
+
+int main(int argc, char** argv)
+{
+    AppOptions options;
+    if (!parseArguments(argc, argv, options))
+        return EXIT_FAILURE;
+
     std::vector<const char*> buildingTexturePaths ={
         "textures/hex.png",  //floor
         "textures/white_marble1.png", //walls
@@ -318,10 +1135,113 @@ int main()
         "textures/perlinNoise3.jpeg",
     };
     
+    //The CPU backend does not need an OpenGL context at all
+    if (options.cpu)
+    {
+        std::vector<CpuSceneSource> sources = {
+            {"building", buildingTexturePaths},
+            {"fractal", {}},
+            {"terrain", terrainTexturePaths},
+            {"tile", tileTexturePaths}
+        };
+        return renderCpu(sources, options) == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
+
+    HeadlessContext headlessContext;
+    if (options.headless || options.benchmark)
+    {
+        if (setupHeadless(headlessContext) != 0)
+            return EXIT_FAILURE;
+    }
+    else
+    {
+        setupDependencies();
+    }
+    
+    ProgramBinaryCache::setDirectory(options.shaderCacheDir);
+    GLuint quad = screenSizeQuad();
+    FrameConstantsBuffer constantsBuffer;
+    constantsBuffer.create();
+    GpuProfiler profiler;
+    profiler.create();
+    Scene scene, buildingScene,fractalScene,terrainScene,tileScene;
+    
+    buildingScene.name = "building";
+    fractalScene.name = "fractal";
+    terrainScene.name = "terrain";
+    tileScene.name = "tile";
+    buildingScene.setShader(Shader("Shaders/scene1/scene1_vertex.glsl",
+                           "Shaders/scene1/scene1_fragment.glsl"));
+    fractalScene.setShader(Shader("Shaders/scene2/scene2_vertex.glsl",
+                           "Shaders/scene2/scene2_fragment.glsl"));
+    terrainScene.setShader(Shader("Shaders/scene3/scene3_vertex.glsl",
+                           "Shaders/scene3/scene3_fragment.glsl"));
+    tileScene.setShader(Shader("Shaders/scene4/scene4_vertex.glsl",
+                           "Shaders/scene4/scene4_fragment.glsl"));
+    //Headless heatmaps only use the single pass shaders
+    if (options.deferred && !(options.headless && options.debugMode != 0))
+    {
+        buildingScene.setDeferredShaders("Shaders/scene1/scene1_vertex.glsl", "Shaders/scene1/scene1_fragment.glsl");
+        fractalScene.setDeferredShaders("Shaders/scene2/scene2_vertex.glsl", "Shaders/scene2/scene2_fragment.glsl");
+        terrainScene.setDeferredShaders("Shaders/scene3/scene3_vertex.glsl", "Shaders/scene3/scene3_fragment.glsl");
+        tileScene.setDeferredShaders("Shaders/scene4/scene4_vertex.glsl", "Shaders/scene4/scene4_fragment.glsl");
+    }
+    
     buildingScene.loadTextures(buildingTexturePaths);
     terrainScene.loadTextures(terrainTexturePaths);
     tileScene.loadTextures(tileTexturePaths);
+    //The heightmap bakes draw with the scene programs, which read the frame constants
+    constantsBuffer.update(frameConstants(glm::vec2((float)Heightmap::SIZE), 0.0f));
+    for (Scene* s : {&buildingScene, &fractalScene, &terrainScene, &tileScene})
+    {
+        s->setRelaxation(sceneRelaxation(s->name, options));
+        s->setNormalEstimator(sceneNormalEstimator(s->name, options));
+        s->setHeightfieldMarch(options.heightfieldMarch);
+        s->setLodBias(sceneLodBias(s->name, options));
+        s->lightingScale = sceneLightingScale(s->name, options);
+        if (options.heightmap)
+            s->bakeHeightmap(quad);
+    }
+    constantsBuffer.endFrame();
+
+    if (options.headless || options.benchmark)
+    {
+        std::vector<Scene*> scenes = {&buildingScene, &fractalScene, &terrainScene, &tileScene};
+        int result = options.benchmark ? runBenchmark(quad, scenes, constantsBuffer, profiler, options)
+                                       : renderHeadless(quad, scenes, constantsBuffer, profiler, options);
+        profiler.release();
+        constantsBuffer.release();
+        headlessContext.destroy();
+        return result == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
+
     scene = tileScene;
+    CameraPath recordedPath;
+    double lastProfilerReadout = 0.0;
+    bool printKeyWasDown = false;
+    int debugMode = options.debugMode;
+    bool debugKeyWasDown = false;
+    scene.setDebugMode(debugMode);
+    ScenePasses passes;
+    passes.useConePrepass = options.conePrepass;
+    passes.useTemporalCache = options.temporalCache;
+    passes.useDeferred = options.deferred;
+    //Allocated up front so "X" and "B" can switch them on at any time
+    passes.useTaa = options.deferred;
+    passes.useCheckerboard = true;
+    passes.create(SCR_WIDTH, SCR_HEIGHT);
+    passes.useTaa = options.taa;
+    bool checkerboard = options.checkerboard;
+    bool checkerboardKeyWasDown = false;
+    bool coneKeyWasDown = false;
+    bool temporalKeyWasDown = false;
+    bool taaKeyWasDown = false;
+    //With a frame budget the scene renders into a smaller target that is stretched over the window
+    DynamicResolution dynamicResolution;
+    bool dynamic = (options.frameBudget > 0.0);
+    if (dynamic)
+        dynamicResolution.create(SCR_WIDTH, SCR_HEIGHT, options.frameBudget);
+    int measuredFrames = 0;
    
 	// render loop
 	// -----------
@@ -331,14 +1251,90 @@ int main()
 		updateDeltaTime();
 		// input
 		processInput(window);
+		if (!options.recordPathFile.empty())
+			recordedPath.record(camera, (float)glfwGetTime());
 
 		// render
 		// ------
-		glClearColor(0.1f, 0.1f, 0.1f, 1.0f);
-		glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+        profiler.beginFrame();
+        //The heatmap counts the steps of the single pass shader
+        passes.useDeferred = options.deferred && debugMode == 0;
+        passes.useCheckerboard = checkerboard && debugMode == 0;
+        int renderWidth = dynamic ? dynamicResolution.getRenderWidth() : SCR_WIDTH;
+        int renderHeight = dynamic ? dynamicResolution.getRenderHeight() : SCR_HEIGHT;
+        constantsBuffer.update(frameConstants(glm::vec2(renderWidth, renderHeight), glfwGetTime(), passes.jitter(scene)));
+        renderScene(quad, scene, passes, dynamic ? &dynamicResolution.getRenderTarget() : nullptr, renderWidth, renderHeight, profiler);
+        if (dynamic)
+            dynamicResolution.upscale(profiler);
+        constantsBuffer.endFrame();
+        profiler.endFrame();
+
+        if (dynamic && profiler.getMeasuredFrames() != measuredFrames)
+        {
+            measuredFrames = profiler.getMeasuredFrames();
+            if (dynamicResolution.update(profiler.getLastFrameTime()))
+                passes.resize(dynamicResolution.getRenderWidth(), dynamicResolution.getRenderHeight());
+        }
+
+        //GPU times in the title twice a second, the full table on "P"
+        if (glfwGetTime() - lastProfilerReadout > 0.5)
+        {
+            std::string title = "OpenGL Window - " + profiler.summary();
+            if (dynamic)
+                title += " | " + std::to_string((int)std::lround(dynamicResolution.getScale() * 100.0f)) + "% resolution";
+            glfwSetWindowTitle(window, title.c_str());
+            lastProfilerReadout = glfwGetTime();
+        }
+        bool printKeyDown = (glfwGetKey(window, GLFW_KEY_P) == GLFW_PRESS);
+        if (printKeyDown && !printKeyWasDown)
+            profiler.print(std::cout);
+        printKeyWasDown = printKeyDown;
 
-        scene.bindTextures();
-        renderScreenSizeQuad(quad, scene.shader);
+        //"H" cycles through the step count heatmaps
+        bool debugKeyDown = (glfwGetKey(window, GLFW_KEY_H) == GLFW_PRESS);
+        if (debugKeyDown && !debugKeyWasDown)
+        {
+            debugMode = (debugMode + 1) % DEBUG_MODE_COUNT;
+            scene.setDebugMode(debugMode);
+            std::cout << "Step heatmap: " << DEBUG_MODE_NAMES[debugMode] << std::endl;
+        }
+        debugKeyWasDown = debugKeyDown;
+
+        //"C" switches the cone prepass on and off
+        bool coneKeyDown = (glfwGetKey(window, GLFW_KEY_C) == GLFW_PRESS);
+        if (coneKeyDown && !coneKeyWasDown)
+        {
+            passes.useConePrepass = !passes.useConePrepass;
+            std::cout << "Cone prepass: " << (passes.useConePrepass ? "on" : "off") << std::endl;
+        }
+        coneKeyWasDown = coneKeyDown;
+
+        //"T" switches the temporal cache on and off
+        bool temporalKeyDown = (glfwGetKey(window, GLFW_KEY_T) == GLFW_PRESS);
+        if (temporalKeyDown && !temporalKeyWasDown)
+        {
+            passes.useTemporalCache = !passes.useTemporalCache;
+            std::cout << "Temporal cache: " << (passes.useTemporalCache ? "on" : "off") << std::endl;
+        }
+        temporalKeyWasDown = temporalKeyDown;
+
+        //"X" switches temporal anti-aliasing on and off
+        bool taaKeyDown = (glfwGetKey(window, GLFW_KEY_X) == GLFW_PRESS);
+        if (taaKeyDown && !taaKeyWasDown)
+        {
+            passes.useTaa = !passes.useTaa;
+            std::cout << "TAA: " << (passes.useTaa ? "on" : "off") << std::endl;
+        }
+        taaKeyWasDown = taaKeyDown;
+
+        //"B" switches checkerboard rendering on and off
+        bool checkerboardKeyDown = (glfwGetKey(window, GLFW_KEY_B) == GLFW_PRESS);
+        if (checkerboardKeyDown && !checkerboardKeyWasDown)
+        {
+            checkerboard = !checkerboard;
+            std::cout << "Checkerboard: " << (checkerboard ? "on" : "off") << std::endl;
+        }
+        checkerboardKeyWasDown = checkerboardKeyDown;
         
 		// glfw: swap buffers and poll IO events (keys pressed/released, mouse moved etc.)
 		// -------------------------------------------------------------------------------
@@ -347,6 +1343,13 @@ int main()
 	}
 
 
+	if (!options.recordPathFile.empty())
+		recordedPath.save(options.recordPathFile);
+	passes.release();
+	dynamicResolution.release();
+	profiler.release();
+	constantsBuffer.release();
+
 	// glfw: terminate, clearing all previously allocated GLFW resources.
 	// ------------------------------------------------------------------
 	glfwTerminate();